@@ -71,6 +71,12 @@ typedef struct {
   int final_ubfs;           //final ubfs
   int cache_capacity;       //hash table capacity for the vtree
 
+  //budgets of counting and compiling (0 for none)
+  c2dSize conflict_budget;    //number of conflicts
+  c2dSize propagation_budget; //number of propagated literals
+  double time_budget;         //seconds
+  c2dSize memory_budget;      //megabytes (of the learned clauses)
+
   //flags
   BOOLEAN in_memory;     //whether or not to save nnf to file
   BOOLEAN check_entail;  //check if the nnf entails the input cnf
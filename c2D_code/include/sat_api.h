@@ -171,7 +171,8 @@ void sat_unmark_clause(Clause* clause);
  * SatState
  ******************************************************************************/
 
-//constructs a SatState from an input cnf file
+//constructs a SatState from an input cnf file (in DIMACS format)
+//returns NULL if the file cannot be read, or is not a cnf
 SatState* sat_state_new(const char* file_name);
 
 //frees the SatState
@@ -192,6 +193,22 @@ void sat_undo_unit_resolution(SatState* sat_state);
 //it is used to decide whether the sat state is at the right decision level for adding clause.
 BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state);
 
+//sets the budgets of the search from now on: the number of conflicts and of
+//propagated literals, the seconds of wall-clock time and the megabytes of memory
+//its learned clauses can take; 0 for no limit
+void sat_set_budget(SatState* sat_state, c2dSize conflicts, c2dSize propagations, double seconds, c2dSize megabytes);
+
+//asks unit resolution on sat state to stop as soon as it can (from any thread)
+void sat_interrupt(SatState* sat_state);
+
+//returns 1 if unit resolution was stopped because a budget ran out or
+//sat_interrupt() was called, 0 otherwise
+//
+//once stopped, sat_decide_literal() and sat_assert_clause() return a clause which
+//cannot be asserted (sat_at_assertion_level() is 0 for it), so that the search backtracks
+//all the way up
+BOOLEAN sat_stopped(const SatState* sat_state);
+
 #endif //SATAPI_H_
 
 /******************************************************************************
@@ -32,6 +32,10 @@ void compile_dispatcher(NNF_NODE* node, Clause** learned_clause, DVtree* vtree,
 
 /******************************************************************************
  * Main compilation code
+ *
+ * If a budget of the sat state runs out, or it is interrupted, the sat state
+ * returns a clause that cannot be asserted, so compilation backtracks all the way up
+ * No nnf is then returned (NULL)
  ******************************************************************************/
  
 //hash table capacity (formula caching and unique nodes)
@@ -55,6 +59,10 @@ NnfManager* compile_vtree(VtreeManager* manager, SatState* sat_state) {
   else node = ZERO_NNF_NODE; //cnf is inconsistent
 
   sat_undo_unit_resolution(sat_state);
+  if(sat_stopped(sat_state)) { //compilation is unknown
+    nnf_manager_free(nnf_manager);
+    return NULL;
+  }
   nnf_manager_set_root(node,nnf_manager);
   return nnf_manager;
 }
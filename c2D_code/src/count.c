@@ -32,6 +32,10 @@ void count_dispatcher(c2dWmc* count, Clause** learned_clause, DVtree* vtree, Vtr
 
 /******************************************************************************
  * Main (weighted) model counting code
+ *
+ * If a budget of the sat state runs out, or it is interrupted, the sat state
+ * returns a clause that cannot be asserted, so counting backtracks all the way up
+ * The count is then -1 (unknown)
  ******************************************************************************/
 
 c2dWmc count_vtree(VtreeManager* manager, SatState* sat_state) {
@@ -47,6 +51,7 @@ c2dWmc count_vtree(VtreeManager* manager, SatState* sat_state) {
   else count = 0; //cnf is inconsistent
 
   sat_undo_unit_resolution(sat_state);
+  if(sat_stopped(sat_state)) count = -1; //count is unknown
   return count;
 }
 
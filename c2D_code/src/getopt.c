@@ -21,6 +21,11 @@ const char* c2d_version();
 #define FINAL_UBFS     25;
 #define CACHE_CAPACITY 20000003;
 
+#define CONFLICT_BUDGET    0;
+#define PROPAGATION_BUDGET 0;
+#define TIME_BUDGET        0;
+#define MEMORY_BUDGET      0;
+
 #define IN_MEMORY    0;
 #define CHECK_ENTAIL 0;
 #define COUNT_MODELS 0;
@@ -43,6 +48,10 @@ c2dOptions* init_options() {
   options->initial_ubfs       = INITIAL_UBFS;
   options->final_ubfs         = FINAL_UBFS;
   options->cache_capacity     = CACHE_CAPACITY;
+  options->conflict_budget    = CONFLICT_BUDGET;
+  options->propagation_budget = PROPAGATION_BUDGET;
+  options->time_budget        = TIME_BUDGET;
+  options->memory_budget      = MEMORY_BUDGET;
   options->in_memory          = IN_MEMORY;
   options->check_entail       = CHECK_ENTAIL;
   options->count_models       = COUNT_MODELS;
@@ -66,6 +75,10 @@ c2dOptions* get_options(int argc, char** argv) {
       {"initial_ubfs",   required_argument, 0, 'u'},
       {"final_ubfs",     required_argument, 0, 'f'},
       {"cache_capacity", required_argument, 0, 's'},
+      {"conflicts",      required_argument, 0, 'K'},
+      {"propagations",   required_argument, 0, 'P'},
+      {"time",           required_argument, 0, 'T'},
+      {"memory",         required_argument, 0, 'M'},
       {"in_memory",      no_argument,       0, 'i'},
       {"check_entail",   no_argument,       0, 'E'},
       {"count_models",   no_argument,       0, 'C'},
@@ -75,7 +88,7 @@ c2dOptions* get_options(int argc, char** argv) {
     };
 
     int index = 0;
-    int argument = getopt_long(argc,argv,"c:v:o:d:t:m:b:u:f:s:iECWh",long_options,&index);
+    int argument = getopt_long(argc,argv,"c:v:o:d:t:m:b:u:f:s:K:P:T:M:iECWh",long_options,&index);
     if(argument==-1) break;
 
     switch(argument) {
@@ -89,6 +102,10 @@ c2dOptions* get_options(int argc, char** argv) {
       case 'u': options->initial_ubfs       = atoi(optarg);  break;
       case 'f': options->final_ubfs         = atoi(optarg);  break;
       case 's': options->cache_capacity     = atoi(optarg);  break;
+      case 'K': options->conflict_budget    = atol(optarg);  break;
+      case 'P': options->propagation_budget = atol(optarg);  break;
+      case 'T': options->time_budget        = atof(optarg);  break;
+      case 'M': options->memory_budget      = atol(optarg);  break;
       case 'i': options->in_memory          = 1;             break;
       case 'E': options->check_entail       = 1;             break;
       case 'C': options->count_models       = 1;             break;
@@ -134,6 +151,11 @@ c2dOptions* get_options(int argc, char** argv) {
     fprintf(stderr,"%s: option -s must be greater than 0\n",C2D_PACKAGE);
     print_help(C2D_PACKAGE,1);
   }
+  if((long)options->conflict_budget < 0 || (long)options->propagation_budget < 0 ||
+     options->time_budget < 0 || (long)options->memory_budget < 0) {
+    fprintf(stderr,"%s: options -K, -P, -T and -M must not be negative\n",C2D_PACKAGE);
+    print_help(C2D_PACKAGE,1);
+  }
   return options;
 }
 
@@ -141,7 +163,7 @@ void print_help(const char* PACKAGE, int exit_value) {
   printf("%s: CNF to Decision-DNNF Compiler\n", PACKAGE);
   printf("%s\n",c2d_version());
 
-  printf("%s [-c .] [-v .] [-o .] [-d .] [-t .] [-m .] [-b .] [-u .] [-f .] [-s .]   [-i] [-E] [-C] [-W] [-h]\n", PACKAGE);
+  printf("%s [-c .] [-v .] [-o .] [-d .] [-t .] [-m .] [-b .] [-u .] [-f .] [-s .] [-K .] [-P .] [-T .] [-M .]   [-i] [-E] [-C] [-W] [-h]\n", PACKAGE);
    
 
   printf("  --cnf             -c FILE    set input CNF file\n");
@@ -167,6 +189,12 @@ void print_help(const char* PACKAGE, int exit_value) {
 
   printf("  --cache_capacity  -s SIZE    set the hash table capacity for the vtree\n");
 
+  printf("  --conflicts       -K COUNT   stop counting/compiling after COUNT conflicts (default 0: no limit)\n");
+  printf("  --propagations    -P COUNT   stop counting/compiling after COUNT propagated literals (default 0: no limit)\n");
+  printf("  --time            -T SECONDS stop counting/compiling after SECONDS of wall-clock time (default 0: no limit)\n");
+  printf("  --memory          -M MB      stop counting/compiling once the learned clauses take MB megabytes (default 0: no limit)\n");
+  printf("                               a stopped count or compilation is reported as UNKNOWN\n");
+
   printf("  --in_memory       -i         suppress the saving of compiled NNF to a file\n");
   printf("  --check_entail    -E         verify the compiled Decision-DNNF is correct by ensuring it is decomposable and also entails the input CNF\n");
   printf("  --count_models    -C         count the models of the input CNF after compiling it into a Decision-DNNF\n");
@@ -37,6 +37,10 @@ int main(int argc, char* argv[]) {
   start_total_t = start_t = clock();
   printf("\nConstructing CNF...");
   sat_state = sat_state_new(options->cnf_filename);
+  if(sat_state==NULL) {
+    fprintf(stderr,"\nc2D: cannot read CNF file %s\n",options->cnf_filename);
+    exit(1);
+  }
   clock_t sat_t = clock()-start_t;
   printf(" DONE");
   printf("\nCNF stats: ");
@@ -66,18 +70,23 @@ int main(int argc, char* argv[]) {
     printf(" DONE");
   }
 
+  //budgets of counting and compiling
+  sat_set_budget(sat_state,options->conflict_budget,options->propagation_budget,
+                 options->time_budget,options->memory_budget);
+
   //(weighted) model counting
   if(options->model_counter) {
     start_t = clock();
     printf("\nCounting..."); fflush(stdout);
     c2dWmc count = count_vtree(manager,sat_state);
     clock_t count_t = clock()-start_t;
-    printf(" DONE");
+    printf(count<0? " STOPPED": " DONE");
     printf("\n  Learned clauses      \t%"PRIvS"",sat_learned_clause_count(sat_state));
     print_vtree_cache_stats(manager->cache);
     printf("\nCount stats:");
     printf("\n  Count Time\t%0.3fs",((double)(count_t))/CLOCKS_PER_SEC);
-    printf("\n  Count \t%0.3"PRIwmcS"",count);
+    if(count<0) printf("\n  Count \tUNKNOWN");
+    else printf("\n  Count \t%0.3"PRIwmcS"",count);
     printf("\nTotal Time: %0.3fs\n\n",((double)clock()-start_total_t)/CLOCKS_PER_SEC);
     free(options);
     vtree_manager_free(manager);
@@ -90,6 +99,17 @@ int main(int argc, char* argv[]) {
   printf("\nCompiling..."); fflush(stdout);
   NnfManager* nnf_manager = compile_vtree(manager,sat_state);
   clock_t comp_t = clock()-start_t;
+  if(nnf_manager==NULL) { //stopped
+    printf(" STOPPED");
+    printf("\n  Learned clauses      \t%"PRIvS"",sat_learned_clause_count(sat_state));
+    printf("\n  Compile Time\t%0.3fs",((double)(comp_t))/CLOCKS_PER_SEC);
+    printf("\nNNF: UNKNOWN");
+    printf("\nTotal Time: %0.3fs\n\n",((double)clock()-start_total_t)/CLOCKS_PER_SEC);
+    free(options);
+    vtree_manager_free(manager);
+    sat_state_free(sat_state);
+    return 0;
+  }
   printf(" DONE");
   pprint_bytes("\n  NNF memory      \t",nnf_manager_memory(nnf_manager));
   printf("\n  Learned clauses      \t%"PRIvS"",sat_learned_clause_count(sat_state));
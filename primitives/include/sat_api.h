@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
 
 /******************************************************************************
 * sat_api.h shows the function prototypes you should implement to create libsat.a
@@ -38,6 +39,10 @@ typedef unsigned long c2dSize;  //for variables, clauses, and various things
 typedef signed long c2dLiteral; //for literals
 typedef double c2dWmc;          //for (weighted) model count
 
+//hands the bytes of a proof to where it goes (see sat_set_proof), and returns the
+//buffer to write the next bytes to
+typedef unsigned char* (*ProofFlush)(void* sink, unsigned char* bytes, size_t num_bytes);
+
 
 /****************************************/
 /** Our own defines **/
@@ -56,8 +61,74 @@ typedef double c2dWmc;          //for (weighted) model count
 #define decide_call 2
 #define learn_call 3
 
+// tiers of learned clauses, by their glue (LBD: number of distinct levels)
+// core clauses are kept forever, tier2 clauses while they take part in conflicts,
+// and local clauses only until the next reduction unless they do
+#define tier_core 0
+#define tier_2 1
+#define tier_local 2
+
+#define core_max_lbd 2
+#define tier2_max_lbd 6
+
+// the learned clauses are reduced once reduce_first clauses have been asserted,
+// and after that every time reduce_increment more clauses than last time have been
+#define reduce_first 2000
+#define reduce_increment 300
+
+// each conflict makes the following activity bumps 1/activity_decay larger
+// activities are scaled down once one of them goes over activity_limit
+#define activity_decay 0.95
+#define activity_limit 1e100
+#define not_in_heap ((uint32_t)-1)
+
+// how sat_pick_branch_literal chooses the phase of a var (see sat_set_phase_mode)
+#define phase_positive 0
+#define phase_saved 1
+#define phase_original 2
+#define phase_inverted 3
+#define phase_best 4
+
+// saved phases are reset after rephase_first conflicts, and after that every
+// time rephase_increment more conflicts than last time have happened
+#define rephase_first 1000
+#define rephase_increment 1000
+
+// when sat_restart_due asks for a restart (see sat_set_restart_mode)
+#define restart_none 0
+#define restart_luby 1
+#define restart_glucose 2
+
+// luby restarts happen after luby_unit times the terms of the luby sequence conflicts
+#define luby_unit 100
+
+// glucose restarts happen after glucose_min_conflicts conflicts at least, when the
+// average LBD of the recent learned clauses is glucose_margin times that of all of them
+// the averages are exponential moving ones, with weights ema_fast_alpha and ema_slow_alpha
+#define glucose_min_conflicts 50
+#define glucose_margin 1.25
+#define ema_fast_alpha (1.0 / 32)
+#define ema_slow_alpha (1.0 / 4096)
+
+// returned by sat_solve_assumptions when it was stopped (see sat_stopped)
+#define result_unknown -1
+
+// the clock and the memory of a search with budgets are looked at every
+// budget_check_interval propagated literals (a power of 2)
+#define budget_check_interval 1024
+
+// while a clause of the cnf file has fewer literals than this, the parser looks
+// through them for a repeated or complementary one; then it stamps them
+#define parse_scan_lits 16
+
+// a literal code takes at most this many bytes in a binary DRAT proof
+#define proof_lit_bytes 10
+
 typedef char litstat;
 typedef char callstat;
+typedef char tierstat;
+typedef char phasemode;
+typedef char restartmode;
 
 
 /****************************************/
@@ -72,11 +143,56 @@ typedef struct literal Lit;
 typedef struct var Var;
 typedef struct clause Clause;
 typedef struct sat_state_t SatState;
-typedef struct ClauseNode ClauseNode;
-typedef struct LitNode LitNode;
 typedef struct ClausePtrVector ClausePtrVector;
 typedef struct LitPtrVector LitPtrVector;
+typedef struct BinaryWatch BinaryWatch;
+typedef struct BinaryWatchVector BinaryWatchVector;
+typedef struct ClauseHashSet ClauseHashSet;
+
+
+struct ClausePtrVector
+{
+	Clause** clause;
+	size_t limit; // Total size of the vector
+	size_t current; //Number of vectors in it at present
+
+};
+
 
+struct LitPtrVector
+{
+	Lit** lits;
+	size_t limit; // Total size of the vector
+	size_t current; //Number of vectors in it at present
+
+};
+
+// a binary clause seen from one of its literals: when that literal becomes
+// false, other is implied
+struct BinaryWatch
+{
+	Lit* other;
+	Clause* clause; // only looked at when other is false too (conflict)
+};
+
+struct BinaryWatchVector
+{
+	BinaryWatch* watches;
+	size_t limit; // Total size of the vector
+	size_t current; //Number of vectors in it at present
+
+};
+
+// the clauses of a sat state by their hash (see Clause.hash)
+// open addressing: slots holds capacity clause pointers (a power of 2), NULL when empty
+struct ClauseHashSet
+{
+	Clause** slots;
+	size_t capacity;
+	size_t size; // clauses in the set
+	size_t filled; // slots which are not empty, removed clauses included
+
+};
 
 /******************************************************************************
 * Literals:
@@ -86,22 +202,29 @@ typedef struct LitPtrVector LitPtrVector;
 * --Index of a literal must be of type "c2dLiteral"
 ******************************************************************************/
 
+// all literals of a sat state are stored in one block, lits[2v] and lits[2v+1]
+// being the positive and negative literals of var v (as in values)
+// what changes during the search is kept in the dense arrays of the sat state
 struct literal {
 	c2dLiteral index;
-	ClauseNode* clauses;
-	ClauseNode* clauses_tail;
 	Var* var;
-	Clause* reason; // the reason why literal was implied
-	// NULL if literal is free or decided
 
-};
+	// the slot of this literal in the values array of its sat state
+	// 1 when the literal is true, -1 when false, 0 when its var is free
+	int8_t* value;
+
+	// clauses in which this literal is one of the two watched literals
+	// visited only when the literal becomes false
+	ClausePtrVector watched_clauses;
+
+	// the binary clauses mentioning this literal, with their other literal inline
+	// visited only when the literal becomes false, before watched_clauses
+	BinaryWatchVector binary_watches;
 
-struct LitNode {
-	LitNode* next;
-	Lit* lit;
 };
 
 
+
 /******************************************************************************
 * Variables:
 * --You must represent variables using the following struct
@@ -110,42 +233,25 @@ struct LitNode {
 * --The field "mark" below and its related functions should not be changed
 ******************************************************************************/
 
-struct ClausePtrVector
-{
-	Clause** clause;
-	size_t limit; // Total size of the vector
-	size_t current; //Number of vectors in it at present
-
-};
-
-
-struct LitPtrVector
-{
-	Lit** lits;
-	size_t limit; // Total size of the vector
-	size_t current; //Number of vectors in it at present
-
-};
-
+// the level and reason of a var are kept in the dense arrays of the
+// sat state, indexed by the var index
 struct var {
 
 	c2dSize index;
 
-	c2dSize level;
-
-	c2dSize ticket; // 1 = first var that was implied/decided, 2 = second var that was implied/decided, ...etc
-
 	Lit* pos_lit;
 	Lit* neg_lit;
 	BOOLEAN mark; //THIS FIELD MUST STAY AS IS
 
 	litstat status; // free, implied_pos or implied_neg (by decision/unit resolution), 
 
-	// TODO:
 	// number of clauses which contains this var in original CNF
 	// either literal of var counts, so take absolute value
 	c2dSize num_clause_has;
-	ClausePtrVector original_cnf_array;
+
+	// number of these clauses which are not subsumed
+	// the var is irrelevant when this drops to 0
+	c2dSize unsubsumed_clause_count;
 
 	// Maybe we need this?
 	SatState* state;
@@ -171,18 +277,25 @@ struct clause {
 
 	// the number of fixed literals that make this clause subsumed
 	// 0 when not subsumed.
+	// kept up to date on assign and unassign for original clauses only
 	unsigned long subsuming_literal_count;
-	unsigned long free_literal_count;
 
-	Lit* watch1;
-	Lit* watch2;
-};
+	BOOLEAN learned; // added by sat_assert_clause
 
+	// learned clauses only
+	c2dSize lbd; // number of distinct levels of its literals, lowered when it is used again
+	tierstat tier;
+	BOOLEAN used; // took part in a conflict analysis since the last reduction
+	BOOLEAN deleted; // dropped by the reduction in progress
 
+	// sum of the hashes of its literals, the key of the clause in the clause set
+	uint64_t hash;
 
-struct ClauseNode {
-	ClauseNode* next;
-	Clause* clause;
+	// the two watched literals (distinct literals of the clause)
+	// the clause can only become unit or conflicting once one of them is false
+	// NULL for unit and binary clauses, which are not watched this way
+	Lit* watch1;
+	Lit* watch2;
 };
 
 
@@ -197,20 +310,158 @@ struct sat_state_t {
 	Var* vars;
 	c2dSize num_vars;
 
-	ClauseNode* cnf_head;
-	ClauseNode* cnf_tail;
+	// the original clauses, clauses[i] has index i+1
+	// their literals are stored back to back in clause_literals
+	Clause* clauses;
+	Lit** clause_literals;
 	c2dSize num_orig_clauses;
-	c2dSize num_asserted_clauses;
+	// the cnf file has an empty clause (which is not among clauses), so the
+	// first unit resolution finds a contradiction
+	BOOLEAN empty_clause;
+
+	// original clauses mentioning each literal, one contiguous block per literal
+	// the clauses of the literal with code c are occurrences[occ_offsets[c]..occ_offsets[c+1])
+	// where the positive literal of var v has code 2v and its negative code 2v+1
+	c2dSize* occ_offsets;
+	Clause** occurrences;
+
+	// clauses added by sat_assert_clause, in order; the i-th has index num_orig_clauses+i+1
+	// they are reached by unit resolution only through their watches
+	ClausePtrVector learned_clauses;
+
+	c2dSize num_asserted_clauses; // by sat_assert_clause, including those reduced since
+
+	// learned clauses are reduced once num_asserted_clauses reaches next_reduction
+	c2dSize next_reduction;
+	c2dSize reduction_interval;
+
+	// every clause of the cnf, original or learned, to find duplicates of learned clauses
+	ClauseHashSet clause_set;
+	c2dSize duplicate_clause_count; // learned clauses found in the cnf by sat_assert_clause
+	// the clause asserted by the last sat_assert_clause (the new one or its duplicate)
+	Clause* asserted_clause;
 
 	c2dSize assertion_level;
-	c2dSize ticket_number;
 
-	LitNode* decided_literals; // stack. The head literal is at
-	// the highest decision level
+	// values[2v] is the value of the positive literal of var v and
+	// values[2v+1] that of the negative one (see Lit.value)
+	// kept in sync with Var.status by assign_literal and unassign_literal
+	int8_t* values;
+
+	// the literals, see struct literal
+	Lit* lits;
+
+	// per var state, indexed by var index (entry 0 is unused)
+	// levels[v] is the decision level of v, 1 while v is free
+	// reasons[v] is the clause which implied the literal of v, and binary_reasons[v] the false
+	// literal of the binary clause which did; both are NULL when v is free or decided
+	c2dSize* levels;
+	Clause** reasons;
+	Lit** binary_reasons;
+
+	// scratch space of conflict analysis, reused by every conflict
+	// seen[v] marks the vars met by the analysis in progress (all false in between)
+	// learned_lits collects the literals of the clause being learned
+	BOOLEAN* seen;
+	Lit** learned_lits;
+	// minimization of the learned clause: the reasons left to visit,
+	// and every var it marked as seen
+	Lit** minimize_stack;
+	Lit** minimize_to_clear;
+
+	// literals of the learned clauses before minimization, and how many it removed
+	c2dSize learned_literal_count;
+	c2dSize minimized_literal_count;
+
+	// level_stamps[l] == lbd_stamp marks level l as counted by the lbd in progress
+	c2dSize* level_stamps;
+	c2dSize lbd_stamp;
+
+	// activity[v] of each var, bumped by conflict analysis by activity_inc
+	// heap holds vars by decreasing activity: all free vars, and maybe some assigned ones
+	// heap_positions[v] is the place of v in heap, not_in_heap if it is not there
+	double* activity;
+	double activity_inc;
+	uint32_t* heap;
+	uint32_t* heap_positions;
+	uint32_t heap_size;
+
+	c2dSize num_conflicts; // analyzed by get_asserting_clause
+
+	// saved_phases[v] is 1 if var v was last assigned positive, -1 if negative
+	// best_phases[v] is its phase in the longest trail so far (best_trail_size long),
+	// 0 if it was not there; only kept in phase_best mode
+	phasemode phase_mode;
+	int8_t* saved_phases;
+	int8_t* best_phases;
+	uint32_t best_trail_size;
+
+	// saved phases are reset once num_conflicts reaches next_rephase
+	c2dSize next_rephase;
+	c2dSize rephase_interval;
+
+	// see sat_restart_due
+	restartmode restart_mode;
+	c2dSize conflicts_since_restart;
+	c2dSize num_restarts;
+	double lbd_ema_fast;
+	double lbd_ema_slow;
+	// lit_stamps[code] == lit_stamp marks the literals of the clause being compared
+	c2dSize* lit_stamps;
+	c2dSize lit_stamp;
+
+	// every decided or implied literal, in the order it was assigned
+	// preallocated with one entry per variable
+	Lit** trail;
+	// the order of the trail is the order of conflict analysis, so positions on it
+	// are all the analysis needs to compare; they fit in 32 bits
+	uint32_t trail_size;
+	uint32_t prop_head; // trail[prop_head..trail_size) are not marked by unit resolution yet
+	uint32_t binary_head; // trail[binary_head..trail_size) have not had their binary clauses visited
+
+	// level_starts[i] is the trail position of the decision at level i+2
+	uint32_t* level_starts;
+	c2dSize num_decisions; // the decision level is num_decisions+1
+
 	Clause* conflict_reason;
-	LitNode* implied_literals; // queue
-	LitNode* implied_literals_tail;
 	callstat call_stat;
+
+	// unit clauses of the cnf, learned ones included, whose literals are implied
+	// at level 1 by the first call to sat_unit_resolution
+	ClausePtrVector unit_clauses;
+
+	// budgets of the search (see sat_set_budget), 0 for none
+	// unit resolution stops once num_conflicts reaches conflict_limit,
+	// num_propagations reaches propagation_limit, the monotonic clock reaches
+	// deadline (in seconds), or learned_bytes reaches memory_limit (in bytes)
+	c2dSize conflict_limit;
+	c2dSize propagation_limit;
+	double deadline;
+	c2dSize memory_limit;
+	c2dSize learned_bytes; // memory of the learned clauses kept (see learned_clause_bytes)
+	c2dSize num_propagations; // literals marked by unit resolution
+
+	// set by sat_interrupt, from any thread
+	int interrupt_requested;
+	// unit resolution was stopped, by a budget or sat_interrupt, and does nothing
+	// until the budgets are set again
+	BOOLEAN stopped;
+	// returned by sat_decide_literal and sat_assert_clause once stopped
+	Clause stop_clause;
+
+	// the assumptions found contradictory by the last sat_solve_assumptions
+	// (room for one per var, plus the false one)
+	c2dLiteral* final_conflict;
+	c2dSize final_conflict_size;
+
+	// binary DRAT proof of the clauses learned and deleted (see sat_set_proof)
+	// proof_buffer holds proof_size bytes not handed to proof_flush yet
+	// proof_flush is NULL when no proof is written
+	ProofFlush proof_flush;
+	void* proof_sink;
+	unsigned char* proof_buffer;
+	size_t proof_size;
+	size_t proof_capacity;
 };
 
 
@@ -280,6 +531,26 @@ Lit* sat_neg_literal(const Var* var);
 BOOLEAN sat_implied_literal(const Lit* lit);
 
 
+//returns a literal of the free variable with the highest activity, NULL if all
+//variables are instantiated
+Lit* sat_pick_branch_literal(SatState* sat_state);
+
+//sets how sat_pick_branch_literal chooses phases: "positive", "saved" (the
+//default), "original", "inverted" or "best"
+//returns 0 if there is no such mode, 1 otherwise
+BOOLEAN sat_set_phase_mode(SatState* sat_state, const char* mode);
+
+//breaks the ties between vars of equal activity in sat_pick_branch_literal
+//by the seed; must be called before anything is decided
+void sat_set_seed(SatState* sat_state, c2dSize seed);
+
+//returns a literal to split the search on, chosen by lookahead among the
+//num_candidates free vars occurring in the most clauses; NULL if all variables
+//are instantiated
+//sets *forced if the returned literal is implied by the decisions so far, or, when
+//NULL is returned, if the decisions so far are contradictory
+Lit* sat_lookahead_literal(SatState* sat_state, c2dSize num_candidates, BOOLEAN* forced);
+
 //sets the literal to true, and then runs unit resolution
 //returns a learned clause if unit resolution detected a contradiction, NULL otherwise
 Clause* sat_decide_literal(Lit* lit, SatState* sat_state);
@@ -287,6 +558,10 @@ Clause* sat_decide_literal(Lit* lit, SatState* sat_state);
 //undoes the last literal decision and the corresponding implications obtained by unit resolution
 void sat_undo_decide_literal(SatState* sat_state);
 
+//undoes all the decisions above the given level in one step, as that many calls
+//to sat_undo_decide_literal()
+void sat_backtrack_to_level(c2dSize level, SatState* sat_state);
+
 /******************************************************************************
 * Clauses
 ******************************************************************************/
@@ -303,9 +578,25 @@ Lit** sat_clause_literals(const Clause* clause);
 //returns the number of literals in a clause
 c2dSize sat_clause_size(const Clause* clause);
 
+//returns the LBD a learned clause had when it was learned, 0 for the clauses of the cnf
+c2dSize sat_clause_lbd(const Clause* clause);
+
 //returns 1 if the clause is subsumed, 0 otherwise
 BOOLEAN sat_subsumed_clause(const Clause* clause);
 
+//returns the index of the first of the clauses of the cnf with indices first..last
+//which is falsified by model, 0 if there is none
+//model[v] is v if var v is true, -v if it is false (model[0] is not used)
+//only model and the clauses of the cnf are read, so ranges of clauses can be
+//checked from different threads
+c2dSize sat_falsified_clause(const SatState* sat_state, const c2dLiteral* model, c2dSize first, c2dSize last);
+
+//returns the number of literals of the learned clauses before minimization
+c2dSize sat_learned_literal_count(const SatState* sat_state);
+
+//returns the number of literals removed from the learned clauses by minimization
+c2dSize sat_minimized_literal_count(const SatState* sat_state);
+
 //returns the number of clauses in the cnf of sat state
 c2dSize sat_clause_count(const SatState* sat_state);
 
@@ -319,13 +610,25 @@ c2dSize sat_learned_clause_count(const SatState* sat_state);
 //moreover, it should be called only if sat_at_assertion_level() succeeds
 Clause* sat_assert_clause(Clause* clause, SatState* sat_state);
 
+//adds a clause implied by the cnf (given by literal indices, with the LBD it was
+//learned with) to the learned clauses, and runs unit resolution
+//returns 0 if unit resolution finds a contradiction, 1 otherwise
+//
+//this function can only be called when nothing is decided, such as after a restart
+BOOLEAN sat_import_clause(const c2dLiteral* lits, c2dSize num_lits, c2dSize lbd, SatState* sat_state);
+
 /******************************************************************************
 * SatState
 ******************************************************************************/
 
-//constructs a SatState from an input cnf file
+//constructs a SatState from an input cnf file (in DIMACS format)
+//returns NULL if the file cannot be read, or is not a cnf
 SatState* sat_state_new(const char* file_name);
 
+//constructs a SatState with the original clauses of sat state, which is only read
+//the two share no memory, so they can be used from different threads
+SatState* sat_state_clone(const SatState* sat_state);
+
 //frees the SatState
 void sat_state_free(SatState* sat_state);
 
@@ -344,6 +647,69 @@ void sat_undo_unit_resolution(SatState* sat_state);
 //it is used to decide whether the sat state is at the right decision level for adding clause.
 BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state);
 
+//returns the decision level of the sat state, 1 when nothing is decided
+c2dSize sat_decision_level(const SatState* sat_state);
+
+//returns the assertion level of clause, which must be the one returned last by
+//sat_decide_literal() or sat_assert_clause()
+c2dSize sat_assertion_level(const Clause* clause, const SatState* sat_state);
+
+//sets when sat_restart_due() asks for a restart: "none", "luby" or "glucose" (the default)
+//returns 0 if there is no such mode, 1 otherwise
+BOOLEAN sat_set_restart_mode(SatState* sat_state, const char* mode);
+
+//returns 1 if the search should restart now (by sat_backtrack_to_level(1, sat_state)),
+//0 otherwise
+BOOLEAN sat_restart_due(SatState* sat_state);
+
+//returns the number of restarts asked for by sat_restart_due()
+c2dSize sat_restart_count(const SatState* sat_state);
+
+//sets the budgets of the search from now on: the number of conflicts and of
+//propagated literals, the seconds of wall-clock time and the megabytes of memory
+//its learned clauses can take; 0 for no limit
+//this also clears the stopped state of sat state, and an interruption
+void sat_set_budget(SatState* sat_state, c2dSize conflicts, c2dSize propagations, double seconds, c2dSize megabytes);
+
+//asks unit resolution on sat state to stop as soon as it can
+//this function can be called from any thread, and from a signal handler
+void sat_interrupt(SatState* sat_state);
+
+//returns 1 if unit resolution was stopped because a budget ran out or
+//sat_interrupt() was called, 0 otherwise
+//
+//once stopped, unit resolution fails without a contradiction, and sat_decide_literal()
+//and sat_assert_clause() return a clause which cannot be asserted: the caller is
+//expected to undo its decisions and give up. sat_at_assertion_level() is 0 for it
+BOOLEAN sat_stopped(const SatState* sat_state);
+
+//decides whether the cnf of sat state is satisfiable when the given literals
+//(assumptions) are all true; returns 1 if it is, 0 otherwise, and result_unknown
+//if it was stopped (see sat_stopped)
+//
+//the assumptions are literals of the cnf: indices from -sat_var_count() to
+//sat_var_count(), other than 0. they may repeat, and contradict each other
+//
+//the clauses learned are kept for the next calls. if 1 is returned, a satisfying
+//assignment is left on the sat state until the next call or sat_undo_unit_resolution()
+//this function is called with nothing decided, or after another call to it
+BOOLEAN sat_solve_assumptions(SatState* sat_state, const c2dLiteral* assumptions, c2dSize num_assumptions);
+
+//returns the assumptions which were found contradictory by the last call to
+//sat_solve_assumptions() that returned 0, and sets *size to their number
+//*size is 0 when the cnf is unsatisfiable without assumptions
+const c2dLiteral* sat_final_conflict(const SatState* sat_state, c2dSize* size);
+
+//makes sat state write a binary DRAT proof of the clauses it learns and deletes
+//from now on, to buffer (capacity bytes, at least 2*proof_lit_bytes)
+//whenever buffer fills up, flush(sink, buffer, bytes) is called, and returns the
+//buffer to go on with (capacity bytes too)
+void sat_set_proof(SatState* sat_state, ProofFlush flush, void* sink, unsigned char* buffer, size_t capacity);
+
+//ends the proof of sat state, with the empty clause if the cnf was found
+//unsatisfiable, and hands what is left of it to the flush function
+void sat_end_proof(SatState* sat_state, BOOLEAN unsatisfiable);
+
 /******************************************************************************
 * The functions below are already implemented for you and MUST STAY AS IS
 ******************************************************************************/
@@ -377,28 +743,84 @@ void sat_unmark_clause(Clause* clause);
 // (If say sat) check that the assignment is actually satisfying
 BOOLEAN assignment_is_sat(SatState* sat_state);
 
-// Add toBeAdded in front of head
-void get_ticket_number(Var* v, SatState* sat_state);
-void unget_ticket_number(Var* v, SatState* sat_state);
-
 Clause* get_asserting_clause(SatState* sat_state);
+Clause* make_learned_clause(Lit** lits, c2dSize num_lits);
+unsigned long abstract_level(c2dSize level);
+BOOLEAN lit_redundant(SatState* sat_state, Lit* lit, unsigned long clause_levels, c2dSize* num_to_clear);
+c2dSize minimize_learned_lits(SatState* sat_state, Lit** lits, c2dSize num_lits);
+c2dSize compute_lbd(SatState* sat_state, Lit** lits, c2dSize num_lits);
+tierstat lbd_tier(c2dSize lbd);
+void bump_learned_clause(SatState* sat_state, Clause* c);
+BOOLEAN is_reason_clause(SatState* sat_state, Clause* c);
+int compare_reduce_order(const void* a, const void* b);
+c2dSize learned_clause_bytes(const Clause* c);
+void reduce_learned_clauses(SatState* sat_state);
+BOOLEAN clause1_includes_clause2(SatState* sat_state, Clause* clause1, Clause* clause2);
+Clause* get_clause_duplicate(Clause* clause, SatState* sat_state);
+uint64_t literal_hash(const SatState* sat_state, const Lit* lit);
+uint64_t clause_hash(const SatState* sat_state, const Clause* c);
+void initialize_ClauseHashSet(ClauseHashSet* set);
+void clause_set_grow(ClauseHashSet* set);
+void clause_set_insert(SatState* sat_state, Clause* c);
+void clause_set_remove(SatState* sat_state, Clause* c);
+Clause* clause_set_find(SatState* sat_state, uint64_t hash, c2dSize num_lits, Clause* superset);
+void rewatch_clause(SatState* sat_state, Clause* c);
+BOOLEAN heap_before(const SatState* sat_state, uint32_t v1, uint32_t v2);
+void heap_up(SatState* sat_state, uint32_t pos);
+void heap_down(SatState* sat_state, uint32_t pos);
+void heap_insert(SatState* sat_state, c2dSize v);
+c2dSize heap_pop(SatState* sat_state);
+void bump_var_activity(SatState* sat_state, c2dSize v);
+void decay_var_activity(SatState* sat_state);
+long probe_literal(SatState* sat_state, Lit* lit);
+void save_best_phases(SatState* sat_state);
+void rephase(SatState* sat_state);
+c2dSize luby(c2dSize i);
+void update_lbd_averages(SatState* sat_state, c2dSize lbd);
+BOOLEAN assert_learned_clause(Clause* learned, SatState* sat_state);
+Lit* next_assumption(SatState* sat_state, const c2dLiteral* assumptions, c2dSize num_assumptions, BOOLEAN* refuted);
+void analyze_final(SatState* sat_state, Lit* lit);
+double monotonic_seconds();
+BOOLEAN budget_exhausted(SatState* sat_state);
+void proof_reserve(SatState* sat_state, size_t num_bytes);
+void proof_clause(SatState* sat_state, unsigned char kind, Lit** lits, c2dSize num_lits);
 BOOLEAN mark_a_literal(SatState* sat_state, Lit* lit);
 void unmark_a_literal(SatState* sat_state, Lit* lit);
 Lit* flip_lit(Lit* lit);
 void initialize_Lit(Lit* l);
-void initialize_LitNode(LitNode* l);
 void add(ClausePtrVector* cv, Clause* c);
 void add_LitPtrVector(LitPtrVector* lv, Lit* l);
 void initialize_ClausePtrVector(ClausePtrVector* c);
 void initialize_LitPtrVector(LitPtrVector* l);
 void initialize_Var(Var* v);
 void initialize_Clause(Clause * c);
-void initialize_ClauseNode(ClauseNode* c);
 void initialize_SatState(SatState* s);
-LitNode* append_node_LitNode(LitNode* node, LitNode* tail);
-ClauseNode* append_node_ClauseNode(ClauseNode* node, ClauseNode* tail);
-unsigned int count_free_lit(Clause* c);
-unsigned int count_subsumed_lit(Clause* c);
+void allocate_vars(SatState* state);
+char* read_cnf_file(const char* fname, size_t* size, BOOLEAN* mapped);
+void release_cnf_file(char* bytes, size_t size, BOOLEAN mapped);
+BOOLEAN is_blank(char c);
+const char* skip_blanks(const char* p, const char* end);
+BOOLEAN scan_number(const char** p, const char* end, c2dSize* value);
+void index_orig_clauses(SatState* state, c2dSize num_lits);
+void push_trail(SatState* sat_state, Lit* lit);
+void open_decision_level(SatState* sat_state, Lit* lit);
+void imply_literal(SatState* sat_state, Lit* lit, Clause* reason, c2dSize level);
+void imply_literal_binary(SatState* sat_state, Lit* lit, Lit* false_lit, c2dSize level);
+BOOLEAN propagate_binary(SatState* sat_state, Lit* lit);
+void add_BinaryWatch(BinaryWatchVector* bv, Lit* other, Clause* c);
+void initialize_BinaryWatchVector(BinaryWatchVector* b);
+void assign_literal(Lit* lit);
+void unassign_literal(Lit* lit);
+BOOLEAN is_lit_true(const Lit* lit);
+BOOLEAN is_lit_false(const Lit* lit);
+c2dSize watch_rank(const SatState* sat_state, const Lit* lit);
+void watch_clause(SatState* sat_state, Clause* c);
+c2dSize lit_code(const SatState* sat_state, const Lit* lit);
+c2dSize lit_var_index(const SatState* sat_state, const Lit* lit);
+c2dSize lit_level(const SatState* sat_state, const Lit* lit);
+c2dSize get_last_level(SatState* sat_state, Clause* reason);
+unsigned int count_free_lit(const Clause* c);
+unsigned int count_subsumed_lit(const Clause* c);
 void print_sat_state_clauses(SatState* sat_state);
 void print_clause(Clause* c);
 #endif //SATAPI_H_
@@ -1,3 +1,9 @@
+#define _POSIX_C_SOURCE 200809L // mmap, posix_madvise and clock_gettime
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "sat_api.h"
 
 /******************************************************************************
@@ -61,18 +67,7 @@ BOOLEAN sat_instantiated_var(const Var* var) {
 
 //returns 1 if all the clauses mentioning the variable are subsumed, 0 otherwise
 BOOLEAN sat_irrelevant_var(const Var* var) {
-	const ClausePtrVector* cv = &(var->original_cnf_array);
-	Clause** c = cv->clause;
-	c2dSize size = cv->current;
-
-	for (unsigned int i = 0; i < size; i++)
-	{
-		// this clause isn't subsumed
-		if (count_subsumed_lit(c[i]) == 0)
-			return false;
-	}
-	return true;
-
+	return var->unsubsumed_clause_count == 0;
 }
 
 //returns the number of variables in the cnf of sat state
@@ -90,7 +85,9 @@ c2dSize sat_var_occurences(const Var* var) {
 //index starts from 0, and is less than the number of clauses mentioning the variable
 //this cannot be called on a variable that is not mentioned by any clause
 Clause* sat_clause_of_var(c2dSize index, const Var* var) {
-	return var->original_cnf_array.clause[index];
+	// the codes of the two literals of var are adjacent,
+	// so its clauses are one block: those of the positive literal, then the negative
+	return var->state->occurrences[var->state->occ_offsets[lit_code(var->state, var->pos_lit)] + index];
 }
 
 /******************************************************************************
@@ -123,10 +120,115 @@ Lit* sat_neg_literal(const Var* var) {
 //returns 1 if the literal is implied, 0 otherwise
 //a literal is implied by deciding its variable, or by inference using unit resolution
 BOOLEAN sat_implied_literal(const Lit* lit) {
-	if (lit->index > 0)
-		return lit->var->status == implied_pos;
-	else
-		return lit->var->status == implied_neg;
+	return *lit->value > 0;
+}
+
+//returns a literal of the free variable with the highest activity, NULL if all
+//variables are instantiated
+//
+//the activity of a variable is bumped each time conflict analysis meets it, by an
+//amount that grows after every conflict (so older bumps count less)
+//the literal has the phase the variable had when it was last unassigned, unless
+//the phase mode is "positive" (see sat_set_phase_mode)
+Lit* sat_pick_branch_literal(SatState* sat_state) {
+	if (sat_state->phase_mode >= phase_original && sat_state->num_conflicts >= sat_state->next_rephase)
+		rephase(sat_state);
+	while (sat_state->heap_size > 0) {
+		c2dSize v = heap_pop(sat_state);
+		Var* var = sat_index2var(v, sat_state);
+		// assigned vars are left in the heap, and only dropped here
+		if (!sat_instantiated_var(var)) {
+			if (sat_state->phase_mode != phase_positive && sat_state->saved_phases[v] < 0)
+				return var->neg_lit;
+			return var->pos_lit;
+		}
+	}
+	return NULL;
+}
+
+static const char* phase_mode_names[] = { "positive", "saved", "original", "inverted", "best" };
+
+//sets how sat_pick_branch_literal chooses the phase of a variable, by name:
+//  positive: always the positive literal
+//  saved: the phase the variable had last (the default)
+//  original, inverted, best: saved, but every now and then all saved phases are
+//  reset to positive, to negative, or to those of the longest trail seen so far
+//returns 0 if there is no such mode, 1 otherwise
+BOOLEAN sat_set_phase_mode(SatState* sat_state, const char* mode) {
+	for (int m = phase_positive; m <= phase_best; m++) {
+		if (strcmp(mode, phase_mode_names[m]) == 0) {
+			sat_state->phase_mode = m;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+//breaks the ties between vars of equal activity in sat_pick_branch_literal by the
+//seed, giving each var a random activity below the smallest bump
+//must be called before anything is decided
+void sat_set_seed(SatState* sat_state, c2dSize seed) {
+	uint64_t x = seed * 0x9E3779B97F4A7C15ULL + 1;
+	sat_state->heap_size = 0;
+	for (c2dSize v = 1; v <= sat_state->num_vars; v++) {
+		// xorshift64
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		sat_state->activity[v] = (double)(x >> 11) / 9007199254740992.0 * 1e-3;
+		sat_state->heap_positions[v] = not_in_heap;
+	}
+	for (c2dSize v = 1; v <= sat_state->num_vars; v++)
+		heap_insert(sat_state, v);
+}
+
+//returns a literal to split the search on, found by lookahead: each of the free
+//vars occurring in the most clauses (num_candidates of them) is decided both ways,
+//and the one whose two branches imply the most literals (by the product of the
+//counts) is chosen; NULL if all variables are instantiated
+//
+//if a branch of a candidate leads to a contradiction, the literal of the other
+//branch is returned at once, with *forced set: it is implied by the decisions
+//so far. if both branches do, NULL is returned with *forced set: the decisions
+//so far are contradictory
+//nothing is learned, and the sat state is left as it was
+Lit* sat_lookahead_literal(SatState* sat_state, c2dSize num_candidates, BOOLEAN* forced) {
+	*forced = 0;
+
+	// the candidates, by decreasing number of occurrences
+	Var** candidates = (Var **)malloc((num_candidates + 1) * sizeof(Var*));
+	c2dSize count = 0;
+	for (c2dSize v = 1; v <= sat_state->num_vars; v++) {
+		Var* var = sat_index2var(v, sat_state);
+		if (sat_instantiated_var(var))
+			continue;
+		c2dSize k = (count < num_candidates ? count++ : count);
+		while (k > 0 && candidates[k - 1]->num_clause_has < var->num_clause_has) {
+			candidates[k] = candidates[k - 1];
+			k--;
+		}
+		if (k < num_candidates)
+			candidates[k] = var;
+	}
+
+	Lit* best = NULL;
+	double best_score = -1;
+	for (c2dSize i = 0; i < count; i++) {
+		long pos_implied = probe_literal(sat_state, candidates[i]->pos_lit);
+		long neg_implied = probe_literal(sat_state, candidates[i]->neg_lit);
+		if (pos_implied < 0 || neg_implied < 0) {
+			*forced = 1;
+			best = (pos_implied >= 0 ? candidates[i]->pos_lit : neg_implied >= 0 ? candidates[i]->neg_lit : NULL);
+			break;
+		}
+		double score = (double)(pos_implied + 1) * (double)(neg_implied + 1);
+		if (score > best_score) {
+			best_score = score;
+			best = (pos_implied >= neg_implied ? candidates[i]->pos_lit : candidates[i]->neg_lit);
+		}
+	}
+	free(candidates);
+	return best;
 }
 
 //sets the literal to true, and then runs unit resolution
@@ -136,30 +238,7 @@ BOOLEAN sat_implied_literal(const Lit* lit) {
 //to L+1 so that the decision level of lit and all other literals implied by unit resolution is L+1
 Clause* sat_decide_literal(Lit* lit, SatState* sat_state) {
 	//printstuff(sat_state);
-	// Set the level of lit
-	lit->var->level = (sat_state->decided_literals == NULL) ? 2 : (sat_state->decided_literals->lit->var->level + 1);
-
-	// Set reason to be NULL, since it's decided!
-	lit->reason = NULL;
-
-	// Set status of var
-	if (lit->index > 0)
-		lit->var->status = implied_pos;
-	else
-		lit->var->status = implied_neg;
-	// Add lit to head of decision literals list in sat_state
-	LitNode* lnode = (LitNode*)malloc(sizeof(LitNode));
-	initialize_LitNode(lnode);
-	if (lit->var->level == 1)
-	{
-		//printf("Called get_ticket_number with %d(Decided) at level 1\n", lit->index);
-		//getc(stdin);
-	}
-	get_ticket_number(lit->var, sat_state);
-
-	lnode->lit = lit;
-	lnode->next = sat_state->decided_literals;
-	sat_state->decided_literals = lnode;
+	open_decision_level(sat_state, lit);
 
 	// Do unit res
 	// If succeed, return NULL
@@ -170,23 +249,13 @@ Clause* sat_decide_literal(Lit* lit, SatState* sat_state) {
 	if (sat_unit_resolution(sat_state)) {
 		return NULL;
 	}
+	else if (sat_state->stopped) {
+		return &sat_state->stop_clause;
+	}
 	else {
 		// BOOKMARK
 		//printf("Decision caused conflict: %d\n", lit->index);
-		//LitNode* lnode = sat_state->decided_literals;
-		//printf("Decision literals...\n");
-		//while (lnode != NULL)
-		//{
-		//	printf("%d<%d> ", lnode->lit->index, lnode->lit->var->level);
-		//	lnode = lnode->next;
-		//}
-		//printf("\nImplied literals...\n");
-		//lnode = sat_state->implied_literals;
-		//while (lnode != NULL)
-		//{
-		//	printf("%d<%d> ", lnode->lit->index, lnode->lit->var->level);
-		//	lnode = lnode->next;
-		//}
+		//print_sat_state_clauses(sat_state);
 		Clause* c = get_asserting_clause(sat_state);
 		//printf("Learned clause...\n");
 		//print_clause(c);
@@ -201,93 +270,93 @@ Clause* sat_decide_literal(Lit* lit, SatState* sat_state) {
 void sat_undo_decide_literal(SatState* sat_state) {
 	//printstuff(sat_state);
 	//assert(sat_state != NULL);
-	if (sat_state->decided_literals == NULL)
+	if (sat_state->num_decisions == 0)
 		return;
 
-	LitNode* last_decision = sat_state->decided_literals;
-	c2dSize last_level = last_decision->lit->var->level;
+	c2dSize last_level = sat_decision_level(sat_state);
+	sat_backtrack_to_level(last_level - 1, sat_state);
 
+	// (debug) the popped level must not have reached into a lower level
+	assert(sat_state->trail_size == 0 || lit_level(sat_state, sat_state->trail[sat_state->trail_size - 1]) < last_level);
+	return; //dummy valued
+}
 
-	// Unmark the last decision, set var status to free, and set level of literal to 1
-	unmark_a_literal(sat_state, last_decision->lit);
-	last_decision->lit->var->status = free_var;
-	last_decision->lit->var->level = 1;
-	
-	// delete node from list
-	sat_state->decided_literals = sat_state->decided_literals->next;
-	unget_ticket_number(last_decision->lit->var, sat_state);
-	free(last_decision);
-
-	// For each implied literal at the last decision level, unmark it, set var status to free, and set level of literal to 1
-	// and remove node from list
-	LitNode* lnode = sat_state->implied_literals;
-	LitNode* prev = NULL;
-	while (lnode != NULL) {
-		if (lnode->lit->var->level == last_level) {
-			if (prev == NULL) {
-				sat_state->implied_literals = NULL;
-				LitNode* to_free = lnode;
-				while (to_free != NULL) {
-					if (to_free->lit->var->level != last_level)
-					{
-						//print_sat_state_clauses(sat_state);
-						printf("Freed a lit not at last level!!!!");
-						getc(stdin);
-						exit(1);
-
-					}
-					unmark_a_literal(sat_state, to_free->lit);
-					to_free->lit->var->status = free_var;
-					to_free->lit->var->level = 1;
-					LitNode* hold = to_free->next;
-					unget_ticket_number(to_free->lit->var, sat_state);
-					free(to_free);
-					to_free = hold;
-				}
-				break;
-			}
-			else {
-				LitNode* to_free = lnode;
-				while (to_free != NULL) {
-					if (to_free->lit->var->level != last_level)
-					{
-						//print_sat_state_clauses(sat_state);
-						printf("Freed a lit not at last level!!!!");
-						getc(stdin);
-						exit(1);
-
-					}
-					unmark_a_literal(sat_state, to_free->lit);
-					to_free->lit->var->status = free_var;
-					to_free->lit->var->level = 1;
-					LitNode* hold = to_free->next;
-					unget_ticket_number(to_free->lit->var, sat_state);
-					free(to_free);
-					to_free = hold;
-				}
-				prev->next = NULL;
-				break;
-			}
-		}
-		prev = lnode;
-		lnode = lnode->next;
+//undoes all the decisions above the given level, and the implications obtained
+//by unit resolution after them, as that many calls to sat_undo_decide_literal()
+void sat_backtrack_to_level(c2dSize level, SatState* sat_state) {
+	if (level >= sat_decision_level(sat_state))
+		return;
+
+	if (sat_state->phase_mode == phase_best && sat_state->trail_size > sat_state->best_trail_size)
+		save_best_phases(sat_state);
+
+	sat_state->num_decisions = level - 1;
+	uint32_t level_start = sat_state->level_starts[sat_state->num_decisions];
+
+	// Pop the trail down to the first decision above level, most recent literal first
+	// Only the literals of the undone levels are touched
+	while (sat_state->trail_size > level_start) {
+		Lit* lit = sat_state->trail[--sat_state->trail_size];
+		unmark_a_literal(sat_state, lit);
 	}
-	return; //dummy valued
+	sat_state->prop_head = sat_state->trail_size;
+	sat_state->binary_head = sat_state->trail_size;
 }
 /******************************************************************************
 * Clauses
 ******************************************************************************/
 
+//adds a clause implied by the cnf, such as one learned by another sat state of the
+//same cnf, to the learned clauses and runs unit resolution
+//the literals are given by index, and lbd is the LBD the clause was learned with
+//returns 0 if unit resolution finds a contradiction, so the cnf is unsatisfiable,
+//1 otherwise
+//
+//this function can only be called when nothing is decided (after a restart)
+BOOLEAN sat_import_clause(const c2dLiteral* lits, c2dSize num_lits, c2dSize lbd, SatState* sat_state) {
+	assert(sat_state->num_decisions == 0);
+
+	// literals false at level 1 are false for good, and a true one satisfies the
+	// clause for good: keep the free literals, once each
+	Lit** clause_lits = sat_state->learned_lits;
+	c2dSize num_clause_lits = 0;
+	for (c2dSize i = 0; i < num_lits; i++) {
+		Lit* lit = sat_index2literal(lits[i], sat_state);
+		if (is_lit_true(lit))
+			return 1;
+		if (is_lit_false(lit))
+			continue;
+		BOOLEAN repeated = false;
+		for (c2dSize k = 0; k < num_clause_lits; k++) {
+			if (clause_lits[k] == lit)
+				repeated = true;
+			else if (clause_lits[k]->var == lit->var)
+				return 1; // tautology
+		}
+		if (!repeated)
+			clause_lits[num_clause_lits++] = lit;
+	}
+	if (num_clause_lits == 0)
+		return 0;
+
+	Clause* clause = make_learned_clause(clause_lits, num_clause_lits);
+	clause->lbd = (lbd < num_clause_lits ? lbd : num_clause_lits);
+	clause->tier = lbd_tier(clause->lbd);
+	sat_state->assertion_level = 1;
+	Clause* learned = sat_assert_clause(clause, sat_state);
+	if (learned == NULL || sat_state->stopped)
+		return 1;
+	// nothing can be asserted below level 1
+	free(learned->literals);
+	free(learned);
+	return 0;
+}
+
 //returns a clause structure for the corresponding index
 Clause* sat_index2clause(c2dSize index, const SatState* sat_state) {
-	ClauseNode* ptr = sat_state->cnf_head;
-	c2dSize idx = 1;
-	while (ptr != NULL && index != idx)
-	{
-		idx++;
-		ptr = ptr->next;
-	}
-	return ptr->clause;
+	if (index <= sat_state->num_orig_clauses)
+		return sat_state->clauses + (index - 1);
+	return sat_state->learned_clauses.clause[index - sat_state->num_orig_clauses - 1];
 }
 
 //returns the index of a clause
@@ -305,9 +374,53 @@ c2dSize sat_clause_size(const Clause* clause) {
 	return clause->num_lits;
 }
 
+//returns the LBD (number of distinct levels) a learned clause had when it was
+//learned, 0 for the clauses of the cnf
+c2dSize sat_clause_lbd(const Clause* clause) {
+	return clause->lbd;
+}
+
 //returns 1 if the clause is subsumed, 0 otherwise
 BOOLEAN sat_subsumed_clause(const Clause* clause) {
-	return count_subsumed_lit(clause) != 0;
+	// the counter is only maintained for the original clauses
+	if (clause->learned)
+		return count_subsumed_lit(clause) != 0;
+	return clause->subsuming_literal_count != 0;
+}
+
+//returns the index of the first of the clauses of the cnf with indices first..last
+//which is falsified by model, 0 if there is none
+//model[v] is v if var v is true, -v if it is false
+//
+//the literals of the clauses are one block, walked in order: the code of each
+//literal (its place in the literal block) gives its var and sign, so the literals
+//themselves are not read
+c2dSize sat_falsified_clause(const SatState* sat_state, const c2dLiteral* model, c2dSize first, c2dSize last) {
+	const Lit* lits = sat_state->lits;
+	for (c2dSize i = first; i <= last; i++) {
+		const Clause* clause = sat_state->clauses + (i - 1);
+		Lit** lit = clause->literals;
+		Lit** end = lit + clause->num_lits;
+		for (; lit != end; lit++) {
+			c2dSize code = (c2dSize)(*lit - lits);
+			// the positive literal of var v has code 2v, the negative one 2v+1
+			if ((model[code >> 1] > 0) != (code & 1))
+				break;
+		}
+		if (lit == end)
+			return i;
+	}
+	return 0;
+}
+
+//returns the number of literals of the learned clauses before minimization
+c2dSize sat_learned_literal_count(const SatState* sat_state) {
+	return sat_state->learned_literal_count;
+}
+
+//returns the number of literals removed from the learned clauses by minimization
+c2dSize sat_minimized_literal_count(const SatState* sat_state) {
+	return sat_state->minimized_literal_count;
 }
 
 //returns the number of clauses in the cnf of sat state
@@ -317,46 +430,43 @@ c2dSize sat_clause_count(const SatState* sat_state) {
 
 //returns the number of learned clauses in a sat state (0 when the sat state is constructed)
 c2dSize sat_learned_clause_count(const SatState* sat_state) {
-
-	if (sat_state->cnf_tail == NULL)
-		return 0;
-	return (sat_state->cnf_tail->clause->index) - (sat_state->num_orig_clauses);
+	return sat_state->learned_clauses.current;
 }
 
-// True if clause2's literals are also clause1's literals
-BOOLEAN clause1_includes_clause2(Clause* clause1, Clause* clause2)
+// True if every literal of clause2 is in clause1
+// uses the literal stamps, so it takes time linear in the two clauses
+BOOLEAN clause1_includes_clause2(SatState* sat_state, Clause* clause1, Clause* clause2)
 {
-	Lit** lit1 = clause1->literals;
-	Lit** lit2 = clause2->literals;
-
-	for (unsigned int i = 0; i < clause2->num_lits; i++)
+	c2dSize stamp = ++sat_state->lit_stamp;
+	for (c2dSize i = 0; i < clause1->num_lits; i++)
+		sat_state->lit_stamps[clause1->literals[i] - sat_state->lits] = stamp;
+	for (c2dSize i = 0; i < clause2->num_lits; i++)
 	{
-		BOOLEAN has_lit = false;
-		for (unsigned int j = 0; j < clause1->num_lits; j++)
-		{
-			if (lit1[j] == lit2[i])
-			{
-				has_lit = true;
-				break;
-			}
-		}
-		if (has_lit == false)
+		if (sat_state->lit_stamps[clause2->literals[i] - sat_state->lits] != stamp)
 			return false;
 	}
 	return true;
 }
 
+// returns a clause of the cnf (original or learned) which is the same as clause,
+// or which has all but one of its literals; NULL if there is none
+//
+// the clause hash is a sum over the literals, so the hash of clause without
+// one of its literals is found in constant time, and each of these lookups
+// is expected constant time too
 Clause* get_clause_duplicate(Clause* clause, SatState* sat_state)
 {
-	ClauseNode* ptr = sat_state->cnf_head;
-	while (ptr != NULL)
+	Clause* other = clause_set_find(sat_state, clause->hash, clause->num_lits, clause);
+	if (other != NULL)
+		return other;
+	if (clause->num_lits < 2)
+		return NULL;
+	for (c2dSize i = 0; i < clause->num_lits; i++)
 	{
-		// If our clause is the same as something in the cnf
-		// It isn't useful!
-		if (clause1_includes_clause2(clause, ptr->clause) 
-			&& clause1_includes_clause2(ptr->clause, clause))
-			return ptr->clause;
-		ptr = ptr->next;
+		uint64_t hash = clause->hash - literal_hash(sat_state, clause->literals[i]);
+		other = clause_set_find(sat_state, hash, clause->num_lits - 1, clause);
+		if (other != NULL)
+			return other;
 	}
 	return NULL;
 }
@@ -371,69 +481,51 @@ Clause* sat_assert_clause(Clause* clause, SatState* sat_state) {
 	// Assume clause isn't empty
 	assert(clause != NULL);
 	
-	//print_clause(clause);
-	//printf("\n");
-
-	//Clause* dup = get_clause_duplicate(clause, sat_state);
-	//// Do a check that we're not adding a clause that is already in the cnf
-	//if (dup != NULL)
-	//{
-	//	//print_sat_state_clauses(sat_state);
-	//	printf("Duplicate clause\n");
-	//	print_clause(clause);
-	//	printf("\n");
-
-	//	printf("Conflicting clause\n");
-	//	print_clause(sat_state->conflict_reason);
-	//	
-	//	free(clause->literals);
-	//	free(clause);
-	//	getc(stdin);
-	//	exit(1);
-	//	
-	//	// Set the contradicting clause in sat_state to NULL
-	//	sat_state->conflict_reason = NULL;
-
-	//	// Do unit resolution
-	//	// If unit resolution succeeded, return NULL
-	//	// else return asserting clause
-	//	sat_state->call_stat = learn_call;
-	//	if (sat_unit_resolution(sat_state))
-	//		return NULL;
-	//	else
-	//		return get_asserting_clause(sat_state);
-
-	//}
-	//else
-	//{
-	//	printf("Not dup\n");
-	//}
+	// A clause which is already in the cnf, or is subsumed by one with a single
+	// literal less, is not added again: the clause of the cnf is asserted instead
+	clause->hash = clause_hash(sat_state, clause);
+	Clause* dup = get_clause_duplicate(clause, sat_state);
+	if (dup != NULL)
+	{
+		free(clause->literals);
+		free(clause);
+		sat_state->duplicate_clause_count += 1;
+		rewatch_clause(sat_state, dup);
+		sat_state->asserted_clause = dup;
+		sat_state->conflict_reason = NULL;
+		sat_state->call_stat = learn_call;
+		if (sat_unit_resolution(sat_state))
+			return NULL;
+		if (sat_state->stopped)
+			return &sat_state->stop_clause;
+		return get_asserting_clause(sat_state);
+	}
 
-	// Add assert clause to lit related clauses
-	for (unsigned int i = 0; i < clause->num_lits; i++) {
-		ClauseNode* new_node = (ClauseNode*)malloc(sizeof(ClauseNode));
-		initialize_ClauseNode(new_node);
-		new_node->clause = clause;
+	// The new clause goes into the proof before the reduction, which can delete
+	// clauses it was derived from
+	proof_clause(sat_state, 'a', clause->literals, clause->num_lits);
 
-		Lit* l = clause->literals[i];
-		new_node->next = l->clauses;
-		l->clauses = new_node;
-		if (l->clauses_tail == NULL)
-		{
-			l->clauses_tail = new_node;
-		}
+	// Drop the learned clauses of low value first, so the new clause is kept
+	sat_state->num_asserted_clauses += 1;
+	if (sat_state->num_asserted_clauses >= sat_state->next_reduction) {
+		reduce_learned_clauses(sat_state);
+		sat_state->reduction_interval += reduce_increment;
+		sat_state->next_reduction = sat_state->num_asserted_clauses + sat_state->reduction_interval;
 	}
-	
 
-	// Set the clause index
-	if (sat_state->cnf_tail != NULL)
-		clause->index = sat_state->cnf_tail->clause->index + 1;
+	// Learned clauses are only reached through their watches
+	// the occurrence lists hold the original clauses, whose subsumption is counted
+	watch_clause(sat_state, clause);
 
-	// Add the learned clause to the cnf
-	ClauseNode* cnode = (ClauseNode*)malloc(sizeof(ClauseNode));
-	initialize_ClauseNode(cnode);
-	cnode->clause = clause;
-	sat_state->cnf_tail = append_node_ClauseNode(cnode, sat_state->cnf_tail);
+	// Add the learned clause to the cnf, after the original clauses
+	add(&(sat_state->learned_clauses), clause);
+	clause->index = sat_state->num_orig_clauses + sat_state->learned_clauses.current;
+	sat_state->learned_bytes += learned_clause_bytes(clause);
+	clause_set_insert(sat_state, clause);
+	// a learned unit clause is implied again whenever unit resolution starts over
+	if (clause->num_lits == 1)
+		add(&(sat_state->unit_clauses), clause);
+	sat_state->asserted_clause = clause;
 
 
 	// Set the contradicting clause in sat_state to NULL
@@ -445,6 +537,8 @@ Clause* sat_assert_clause(Clause* clause, SatState* sat_state) {
 	sat_state->call_stat = learn_call;
 	if (sat_unit_resolution(sat_state))
 		return NULL;
+	else if (sat_state->stopped)
+		return &sat_state->stop_clause;
 	else
 	{
 		//BOOKMARK
@@ -452,20 +546,7 @@ Clause* sat_assert_clause(Clause* clause, SatState* sat_state) {
 
 		//printf("Learned clause:\n");
 		//print_clause(clause);
-		//LitNode* lnode = sat_state->decided_literals;
-		//printf("Decision literals...\n");
-		//while (lnode != NULL)
-		//{
-		//	printf("%d<%d> ", lnode->lit->index, lnode->lit->var->level);
-		//	lnode = lnode->next;
-		//}
-		//printf("\nImplied literals...\n");
-		//lnode = sat_state->implied_literals;
-		//while (lnode != NULL)
-		//{
-		//	printf("%d<%d> ", lnode->lit->index, lnode->lit->var->level);
-		//	lnode = lnode->next;
-		//}
+		//print_sat_state_clauses(sat_state);
 
 
 
@@ -499,263 +580,455 @@ Clause* sat_assert_clause(Clause* clause, SatState* sat_state) {
 
 SatState* sat_state_new(const char* cnf_fname)
 {
-	FILE* file = fopen(cnf_fname, "r");
-	if (file == NULL) return NULL;
+	size_t size;
+	BOOLEAN mapped;
+	char* bytes = read_cnf_file(cnf_fname, &size, &mapped);
+	if (bytes == NULL) return NULL;
+	const char* p = bytes;
+	const char* end = bytes + size;
 
 	SatState* state = (SatState *)malloc(sizeof(SatState));
 	initialize_SatState(state);
 
+	BOOLEAN header = false; // the p line was read, so the vars exist
+	BOOLEAN valid = true;
+	c2dSize num_counted_clauses = 0;
 
-	size_t line_size = 50;
+	// the literals of all clauses, back to back, and where each clause starts
+	LitPtrVector all_lits;
+	initialize_LitPtrVector(&all_lits);
+	c2dSize* clause_starts = NULL;
+	size_t clauses_limit = 0;
 
-	char* line = (char *)malloc(line_size* sizeof(char));
+	// the clause being read: its literals are all_lits[clause_start..]; past
+	// parse_scan_lits literals, they are stamped with stamp in lit_stamps
+	size_t clause_start = 0;
+	BOOLEAN tautology = false;
+	c2dSize stamp = 0;
 
-	unsigned int num_counted_clauses = 0;
-
-	while (getline(&line, &line_size, file) != -1)
+	// Clauses are read as literals up to a 0, whatever the lines they are on
+	for (;;)
 	{
-		if (line[0] == 'c' || line[0] == '0' || line[0] == '%')
+		p = skip_blanks(p, end);
+		// SATLIB files end with a % line
+		BOOLEAN at_end = (p == end || *p == '%');
+		c2dSize index = 0;
+		BOOLEAN negative = false;
+
+		if (!at_end && *p == 'c')
 		{
+			const char* eol = (const char *)memchr(p, '\n', end - p);
+			p = (eol == NULL ? end : eol + 1);
 			continue;
 		}
-
-		if (line[0] == 'p')
+		if (!at_end && *p == 'p')
 		{
-			char* token;
-			token = strtok(line, " \n\r");
-			token = strtok(NULL, " \n\r");
-			state->num_vars = atoi(strtok(NULL, " \n\r"));
-			state->num_orig_clauses = atoi(strtok(NULL, " \n\r"));
-			//printf("Num vars = %d\n", state->num_vars);
-			//printf("Num original cnf clauses = %d\n", state->num_orig_clauses);
-			state->vars = (Var *)malloc((state->num_vars) * sizeof(Var));
-			int num_vars = state->num_vars;
-			Var* vars = state->vars;
-			for (int i = 0; i < num_vars; i++)
+			c2dSize num_vars, num_clauses;
+			const char* eol = (const char *)memchr(p, '\n', end - p);
+			p = skip_blanks(p + 1, end);
+			if (header || end - p < 3 || memcmp(p, "cnf", 3) != 0)
 			{
-				initialize_Var(&(vars[i]));
-				vars[i].index = i + 1;
-				vars[i].state = state;
-				vars[i].neg_lit->index = -(i + 1);
-				vars[i].pos_lit->index = i + 1;
-				vars[i].pos_lit->var = &(vars[i]);
-				vars[i].neg_lit->var = &(vars[i]);
-
+				valid = false;
+				break;
 			}
+			p = skip_blanks(p + 3, end);
+			BOOLEAN counts = scan_number(&p, end, &num_vars);
+			p = skip_blanks(p, end);
+			if (!counts || !scan_number(&p, end, &num_clauses) || (eol != NULL && p > eol))
+			{
+				valid = false;
+				break;
+			}
+			header = true;
+			state->num_vars = num_vars;
+			allocate_vars(state);
+			stamp = ++state->lit_stamp;
+			// room for the announced clauses, grown if the file has more
+			clauses_limit = num_clauses;
+			state->clauses = (Clause *)malloc((clauses_limit + 1) * sizeof(Clause));
+			clause_starts = (c2dSize *)malloc((clauses_limit + 1) * sizeof(c2dSize));
 			continue;
 		}
-
-		// Otherwise, create a clause
-		Clause* clause = (Clause *)malloc(sizeof(Clause));
-		initialize_Clause(clause);
-
-		//// Walk through it once first to count number of literals in clause
-		//// By counting the number of spaces in the line
-
-		//int num_lits = 0;
-		//for (int i = 0; line[i] != '\0'; i++)
-		//{
-		//	if (line[i] == ' ')
-		//		num_lits++;
-		//}
-
-		//if (num_lits == 0)
-		//{
-		//	free(clause);
-		//	continue;
-		//}
-		//printf(" %d ", num_lits);
-
-		//// Walk through it again to point to the literals
-		//clause->num_lits = num_lits;
-		//clause->literals = (Lit **)malloc(num_lits*sizeof(Lit*));
-		
-		int i = 0;
-		LitPtrVector lpv;
-		initialize_LitPtrVector(&lpv);
-
-		char* token = strtok(line, " \r\n");
-		while (token != NULL)
+		if (!at_end)
 		{
-			if (token[0] == '0')
+			negative = (*p == '-');
+			if (negative)
+				p++;
+			if (!header || !scan_number(&p, end, &index) || index > state->num_vars)
+			{
+				valid = false;
 				break;
-			int lit_index = atoi(token);
-			Lit* lit;
-
-			// Get the literal
-			if (lit_index > 0) // pos lit
-				lit = state->vars[lit_index - 1].pos_lit;
-			else
-				lit = state->vars[(-1 * lit_index) - 1].neg_lit;
-
-			// Put into lit ptr vector
-			add_LitPtrVector(&lpv, lit);
-
-			// Put this clause to the vector of the variable
-			add(&(lit->var->original_cnf_array), clause);
-			lit->var->num_clause_has += 1;
-
-			// Put this clause to the list of the literal
-			ClauseNode* cnode = (ClauseNode*)malloc(sizeof(ClauseNode));
-			initialize_ClauseNode(cnode);
-			cnode->clause = clause;
-			if (lit->clauses == NULL)
-				lit->clauses = cnode;
-			lit->clauses_tail = append_node_ClauseNode(cnode, lit->clauses_tail);
-
-
-			token = strtok(NULL, " ");
-			i++;
-
-		}
-		if (i == 0)
-		{
-			free(clause);
-			continue;
+			}
 		}
-			
-		num_counted_clauses++;
-		clause->num_lits = lpv.current;
-		//printf("%d ", clause->num_lits);
-		clause->literals = lpv.lits;
 
-		// for (int i = 0; i < num_lits; i++)
-		// {
-		// 	printf(" %d ", clause->literals[i]->index);
-		// }
-
-		// Special case: if num_lits = 1, then unit clause. 
-		// Add this to the implied literal list
-		if (i == 1)
+		if (index != 0)
 		{
-			Lit * unit_lit = clause->literals[0];
-			// Set the variable to be implied as pos/neg
-			// But check first that there is no crazy contradiction already.
-			if (unit_lit->var->status != free_var)
+			// the positive literal of var v has code 2v, the negative one 2v+1
+			c2dSize code = 2 * index + negative;
+			Lit* lit = state->lits + code;
+			c2dSize clause_size = all_lits.current - clause_start;
+
+			// A literal repeated in the clause is only kept once
+			// A clause mentioning both literals of a variable is always satisfied
+			// a short clause is looked through, as it is in cache; the literals
+			// of a long one are stamped, once it gets long
+			if (clause_size < parse_scan_lits)
 			{
-				if ((unit_lit->var->status == implied_pos && unit_lit->index < 0)
-					|| (unit_lit->var->status == implied_neg && unit_lit->index > 0))
+				BOOLEAN repeated = false;
+				for (size_t k = clause_start; k < all_lits.current; k++)
 				{
-					unit_lit->var->status = conflicting;
-					state->conflict_reason = clause;
+					if (all_lits.lits[k] == lit)
+						repeated = true;
+					else if (all_lits.lits[k] == state->lits + (code ^ 1))
+						tautology = true;
 				}
-
+				if (repeated)
+					continue;
 			}
 			else
 			{
-				if (unit_lit->index > 0)
-					unit_lit->var->status = implied_pos;
-				else
-					unit_lit->var->status = implied_neg;
-
+				if (clause_size == parse_scan_lits)
+				{
+					for (size_t k = clause_start; k < all_lits.current; k++)
+						state->lit_stamps[all_lits.lits[k] - state->lits] = stamp;
+				}
+				if (state->lit_stamps[code] == stamp)
+					continue;
+				if (state->lit_stamps[code ^ 1] == stamp)
+					tautology = true;
+				state->lit_stamps[code] = stamp;
 			}
+			add_LitPtrVector(&all_lits, lit);
+			continue;
+		}
 
-			// Set the reason as this clause 
-			// (note since level is initialized as 1, no change needs to be made)
-			unit_lit->reason = clause;
-
-			//Put into a LitNode and put into list of implied literals
-			LitNode* imp_lit_node = (LitNode*)malloc(sizeof(LitNode));
-			initialize_LitNode(imp_lit_node);
-			get_ticket_number(unit_lit->var, state);
-			imp_lit_node->lit = unit_lit;
-			imp_lit_node->next = state->implied_literals;
-			state->implied_literals = imp_lit_node;
-
+		// A 0, or the end of the file: the clause is complete
+		// a 0 on its own is an empty clause, which no assignment satisfies;
+		// it is not counted, and neither are tautologies
+		if (all_lits.current == clause_start && !at_end)
+		{
+			state->empty_clause = true;
 		}
-		// put the clause into the cnf list
-
-		ClauseNode* clause_node = (ClauseNode *)malloc(sizeof(ClauseNode));
-		initialize_ClauseNode(clause_node);
-		clause_node->clause = clause;
-		clause->index = (state->cnf_tail == NULL) ? 1 : (state->cnf_tail->clause->index) + 1;
-		if (state->cnf_head == NULL)
-			state->cnf_head = clause_node;
-		//state->cnf_tail = append_node(clause_node, state->cnf_tail); 
-		if (state->cnf_tail != NULL) {
-			(state->cnf_tail)->next = clause_node;
+		else if (all_lits.current == clause_start || tautology)
+		{
+			all_lits.current = clause_start;
 		}
-		state->cnf_tail = clause_node;
-		//printf("DID I GET HERE?");
+		else
+		{
+			if (num_counted_clauses == clauses_limit)
+			{
+				clauses_limit = 2 * clauses_limit + 1;
+				state->clauses = (Clause *)realloc(state->clauses, clauses_limit * sizeof(Clause));
+				clause_starts = (c2dSize *)realloc(clause_starts, clauses_limit * sizeof(c2dSize));
+			}
+			Clause* clause = state->clauses + num_counted_clauses;
+			initialize_Clause(clause);
+			clause->index = num_counted_clauses + 1;
+			clause->num_lits = all_lits.current - clause_start;
+			clause_starts[num_counted_clauses] = clause_start;
+			num_counted_clauses++;
+		}
+		if (at_end)
+			break;
+		clause_start = all_lits.current;
+		tautology = false;
+		stamp = ++state->lit_stamp;
+	}
+	release_cnf_file(bytes, size, mapped);
 
+	if (!valid || !header)
+	{
+		free(all_lits.lits);
+		free(clause_starts);
+		sat_state_free(state);
+		return NULL;
 	}
-	//printstuff(state);
-	//printf("DID I FINISH MAKING SATSTATE");
-	//printf("Num counted clauses is... %d\n", num_counted_clauses);
-	//print_sat_state_clauses(state);
-	return state;
-}
 
+	state->num_orig_clauses = num_counted_clauses;
 
-//frees the SatState
-void sat_state_free(SatState* sat_state) {
+	// The literal block does not move anymore, so the clauses can point into it
+	state->clause_literals = all_lits.lits;
+	for (c2dSize i = 0; i < num_counted_clauses; i++)
+		state->clauses[i].literals = all_lits.lits + clause_starts[i];
+	free(clause_starts);
 
+	index_orig_clauses(state, all_lits.current);
 
-	for (unsigned int i = 0; i < sat_state->num_vars; i++)
+	//print_sat_state_clauses(state);
+	return state;
+}
+
+// returns the bytes of the file fname and sets *size to their number, NULL if
+// it cannot be read
+// a regular file is mapped into memory (*mapped is then 1), without copying it;
+// anything else, such as a pipe, is read into a buffer
+char* read_cnf_file(const char* fname, size_t* size, BOOLEAN* mapped)
+{
+	int fd = open(fname, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
 	{
-		// For each literal, delete the list clauses (whole list, just the nodes), if not NULL
-		ClauseNode* pos_lit_c = sat_state->vars[i].pos_lit->clauses;
-		ClauseNode* neg_lit_c = sat_state->vars[i].neg_lit->clauses;
-		ClauseNode* ptr = pos_lit_c;
-		while (ptr != NULL)
+		char* bytes = (char *)mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (bytes != MAP_FAILED)
 		{
-			ptr = ptr->next;
-			free(pos_lit_c);
-			pos_lit_c = ptr;
+			// the scan goes through it once, front to back
+			posix_madvise(bytes, info.st_size, POSIX_MADV_SEQUENTIAL);
+			close(fd);
+			*size = info.st_size;
+			*mapped = true;
+			return bytes;
 		}
-		ptr = neg_lit_c;
-		while (ptr != NULL)
+	}
+
+	size_t limit = 1 << 16;
+	char* bytes = (char *)malloc(limit);
+	ssize_t num_read;
+	*size = 0;
+	*mapped = false;
+	while ((num_read = read(fd, bytes + *size, limit - *size)) > 0)
+	{
+		*size += num_read;
+		if (*size == limit)
 		{
-			ptr = ptr->next;
-			free(neg_lit_c);
-			neg_lit_c = ptr;
+			limit *= 2;
+			bytes = (char *)realloc(bytes, limit);
 		}
+	}
+	close(fd);
+	if (num_read < 0)
+	{
+		free(bytes);
+		return NULL;
+	}
+	return bytes;
+}
 
-		// For each var, delete original_cnf_array (delete the array in this vector)
-		free((sat_state->vars[i].original_cnf_array).clause);
+// frees the bytes returned by read_cnf_file
+void release_cnf_file(char* bytes, size_t size, BOOLEAN mapped)
+{
+	if (mapped)
+		munmap(bytes, size);
+	else
+		free(bytes);
+}
+
+// true for spaces, tabs, line ends and other control characters
+BOOLEAN is_blank(char c)
+{
+	return (unsigned char)c <= ' ';
+}
+
+// returns the first of the bytes from p on which is not a blank, end if none is
+const char* skip_blanks(const char* p, const char* end)
+{
+	while (p < end && is_blank(*p))
+		p++;
+	return p;
+}
+
+// reads the decimal number at *p into *value, and moves *p past it
+// returns 0 if there is no number there, it has more than 18 digits (so it cannot
+// overflow), or it is followed by something other than a blank
+BOOLEAN scan_number(const char** p, const char* end, c2dSize* value)
+{
+	const char* q = *p;
+	const char* digits = q;
+	c2dSize number = 0;
+	while (q < end && (unsigned char)(*q - '0') < 10)
+	{
+		number = 10 * number + (*q - '0');
+		q++;
 	}
+	if (q == digits || q - digits > 18 || (q < end && !is_blank(*q)))
+		return false;
+	*p = q;
+	*value = number;
+	return true;
+}
 
-	// Delete vars array
-	free(sat_state->vars);
 
+// allocates the per-variable arrays of a state whose num_vars is known, and
+// initializes its vars and literals
+void allocate_vars(SatState* state) {
+	state->vars = (Var *)malloc((state->num_vars) * sizeof(Var));
+	// every variable is assigned at most once on the trail,
+	// and each decision opens one level
+	state->trail = (Lit **)malloc((state->num_vars) * sizeof(Lit*));
+	state->level_starts = (uint32_t *)malloc((state->num_vars) * sizeof(uint32_t));
+	state->values = (int8_t *)calloc(2 * (state->num_vars) + 2, sizeof(int8_t));
+	state->lits = (Lit *)malloc((2 * (state->num_vars) + 2) * sizeof(Lit));
+	state->levels = (c2dSize *)malloc((state->num_vars + 1) * sizeof(c2dSize));
+	state->reasons = (Clause **)calloc(state->num_vars + 1, sizeof(Clause*));
+	state->binary_reasons = (Lit **)calloc(state->num_vars + 1, sizeof(Lit*));
+	state->seen = (BOOLEAN *)calloc(state->num_vars + 1, sizeof(BOOLEAN));
+	state->learned_lits = (Lit **)malloc((state->num_vars + 1) * sizeof(Lit*));
+	state->minimize_stack = (Lit **)malloc((state->num_vars + 1) * sizeof(Lit*));
+	state->minimize_to_clear = (Lit **)malloc((state->num_vars + 1) * sizeof(Lit*));
+	// levels go from 1 to num_vars+1
+	state->level_stamps = (c2dSize *)calloc(state->num_vars + 2, sizeof(c2dSize));
+	// every var starts in the heap, all with activity 0
+	state->activity = (double *)calloc(state->num_vars + 1, sizeof(double));
+	state->heap = (uint32_t *)malloc((state->num_vars + 1) * sizeof(uint32_t));
+	state->heap_positions = (uint32_t *)malloc((state->num_vars + 1) * sizeof(uint32_t));
+	state->heap_positions[0] = not_in_heap;
+	for (c2dSize v = 1; v <= state->num_vars; v++) {
+		state->heap[v - 1] = (uint32_t)v;
+		state->heap_positions[v] = (uint32_t)(v - 1);
+	}
+	state->heap_size = (uint32_t)state->num_vars;
+	// positive until a var is unassigned, as the phase mode "positive"
+	state->saved_phases = (int8_t *)malloc((state->num_vars + 1) * sizeof(int8_t));
+	memset(state->saved_phases, 1, (state->num_vars + 1) * sizeof(int8_t));
+	state->best_phases = (int8_t *)calloc(state->num_vars + 1, sizeof(int8_t));
+	state->lit_stamps = (c2dSize *)calloc(2 * (state->num_vars) + 2, sizeof(c2dSize));
+	state->final_conflict = (c2dLiteral *)malloc((state->num_vars + 1) * sizeof(c2dLiteral));
+	int num_vars = state->num_vars;
+	Var* vars = state->vars;
+	for (int i = 0; i < num_vars; i++)
+	{
+		initialize_Var(&(vars[i]));
+		vars[i].index = i + 1;
+		vars[i].state = state;
+		vars[i].pos_lit = state->lits + 2 * (i + 1);
+		vars[i].neg_lit = state->lits + 2 * (i + 1) + 1;
+		initialize_Lit(vars[i].pos_lit);
+		initialize_Lit(vars[i].neg_lit);
+		state->levels[i + 1] = 1;
+		vars[i].neg_lit->index = -(i + 1);
+		vars[i].pos_lit->index = i + 1;
+		vars[i].pos_lit->var = &(vars[i]);
+		vars[i].neg_lit->var = &(vars[i]);
+		vars[i].pos_lit->value = state->values + 2 * (i + 1);
+		vars[i].neg_lit->value = state->values + 2 * (i + 1) + 1;
+	}
+}
 
-	// For each clause node in cnf_head list (if not NULL)
-	ClauseNode* cnf_c = sat_state->cnf_head;
-	ClauseNode* cnf_next = cnf_c;
-	while (cnf_next != NULL)
+// builds the occurrence lists, watches and hash set of the original clauses
+// of a state, whose num_lits literals are in clause_literals
+void index_orig_clauses(SatState* state, c2dSize num_lits) {
+	// Build the occurrence lists: count the clauses of each literal,
+	// turn the counts into offsets, then fill each block in clause order
+	c2dSize num_codes = 2 * (state->num_vars + 1);
+	state->occ_offsets = (c2dSize *)calloc(num_codes + 1, sizeof(c2dSize));
+	state->occurrences = (Clause **)malloc((num_lits + 1) * sizeof(Clause*));
+	c2dSize* occ_offsets = state->occ_offsets;
+	for (size_t k = 0; k < num_lits; k++)
+		occ_offsets[lit_code(state, state->clause_literals[k]) + 1]++;
+	for (c2dSize c = 0; c < num_codes; c++)
+		occ_offsets[c + 1] += occ_offsets[c];
+	c2dSize* fill = (c2dSize *)malloc((num_codes + 1) * sizeof(c2dSize));
+	memcpy(fill, occ_offsets, (num_codes + 1) * sizeof(c2dSize));
+
+	// room in the clause set for all the clauses at once
+	while (state->clause_set.capacity < 2 * (state->num_orig_clauses + 1))
+		clause_set_grow(&state->clause_set);
+
+	for (c2dSize i = 0; i < state->num_orig_clauses; i++)
 	{
-		cnf_next = cnf_next->next;
+		Clause* clause = state->clauses + i;
+		for (c2dSize k = 0; k < clause->num_lits; k++) {
+			Lit* lit = clause->literals[k];
+			state->occurrences[fill[lit_code(state, lit)]++] = clause;
+			lit->var->num_clause_has += 1;
+			lit->var->unsubsumed_clause_count += 1;
+		}
 
-		// free the Lit** literals in the clause
-		free(cnf_c->clause->literals);
+		watch_clause(state, clause);
+		clause->hash = clause_hash(state, clause);
+		clause_set_insert(state, clause);
 
-		// free the clause
-		free(cnf_c);
+		// Special case: if num_lits = 1, then unit clause. 
+		// Its literal is implied by the first call to unit resolution
+		if (clause->num_lits == 1)
+			add(&(state->unit_clauses), clause);
+	}
+	free(fill);
+}
 
-		cnf_c = cnf_next;
+//returns a new sat state with the original clauses of sat state, as sat_state_new
+//constructs it from the same file: nothing decided and nothing learned
+//
+//sat state is only read, and the new state shares no memory with it, so each
+//can be used by its own thread
+SatState* sat_state_clone(const SatState* sat_state) {
+	SatState* state = (SatState *)malloc(sizeof(SatState));
+	initialize_SatState(state);
+	state->num_vars = sat_state->num_vars;
+	allocate_vars(state);
+
+	// same literals of the same clauses, in the same order
+	c2dSize num_lits = sat_state->occ_offsets[2 * (sat_state->num_vars + 1)];
+	state->num_orig_clauses = sat_state->num_orig_clauses;
+	state->empty_clause = sat_state->empty_clause;
+	state->clause_literals = (Lit **)malloc((num_lits + 1) * sizeof(Lit*));
+	for (c2dSize k = 0; k < num_lits; k++)
+		state->clause_literals[k] = state->lits + (sat_state->clause_literals[k] - sat_state->lits);
+	state->clauses = (Clause *)malloc((state->num_orig_clauses + 1) * sizeof(Clause));
+	for (c2dSize i = 0; i < state->num_orig_clauses; i++) {
+		Clause* clause = state->clauses + i;
+		initialize_Clause(clause);
+		clause->index = i + 1;
+		clause->num_lits = sat_state->clauses[i].num_lits;
+		clause->literals = state->clause_literals + (sat_state->clauses[i].literals - sat_state->clause_literals);
 	}
+	index_orig_clauses(state, num_lits);
+	return state;
+}
 
+//frees the SatState
+void sat_state_free(SatState* sat_state) {
 
-	// Delete decided_literals (whole list, just the nodes), if not NULL
-	LitNode* lnode = sat_state->decided_literals;
-	LitNode* lnode_next = lnode;
-	while (lnode_next != NULL)
+	for (unsigned int i = 0; i < sat_state->num_vars; i++)
 	{
-		lnode_next = lnode_next->next;
-		free(lnode);
-		lnode = lnode_next;
+		// For each literal, delete the array of its watch list
+		free(sat_state->vars[i].pos_lit->watched_clauses.clause);
+		free(sat_state->vars[i].neg_lit->watched_clauses.clause);
+		free(sat_state->vars[i].pos_lit->binary_watches.watches);
+		free(sat_state->vars[i].neg_lit->binary_watches.watches);
 	}
 
-	// Delete implied_literals (whole list, just the nodes), if not NULL
-	lnode = sat_state->implied_literals;
-	lnode_next = lnode;
-	while (lnode_next != NULL)
+	// Delete vars array
+	free(sat_state->vars);
+
+	// Delete the original clauses, their literals and their occurrence lists
+	free(sat_state->clauses);
+	free(sat_state->clause_literals);
+	free(sat_state->occ_offsets);
+	free(sat_state->occurrences);
+
+	// Delete the learned clauses
+	for (size_t i = 0; i < sat_state->learned_clauses.current; i++)
 	{
-		lnode_next = lnode_next->next;
-		free(lnode);
-		lnode = lnode_next;
+		free(sat_state->learned_clauses.clause[i]->literals);
+		free(sat_state->learned_clauses.clause[i]);
 	}
-
+	free(sat_state->learned_clauses.clause);
+
+	// Delete the trail and the start of each decision level on it
+	free(sat_state->trail);
+	free(sat_state->level_starts);
+	free(sat_state->values);
+	free(sat_state->lits);
+	free(sat_state->levels);
+	free(sat_state->reasons);
+	free(sat_state->binary_reasons);
+	free(sat_state->seen);
+	free(sat_state->learned_lits);
+	free(sat_state->minimize_stack);
+	free(sat_state->minimize_to_clear);
+	free(sat_state->level_stamps);
+	free(sat_state->activity);
+	free(sat_state->heap);
+	free(sat_state->heap_positions);
+	free(sat_state->saved_phases);
+	free(sat_state->best_phases);
+	free(sat_state->lit_stamps);
+	free(sat_state->final_conflict);
+	free(sat_state->clause_set.slots);
+
+
+	free(sat_state->unit_clauses.clause);
 
 	// Delete sat_state
 	free(sat_state);
@@ -794,98 +1067,253 @@ void sat_state_free(SatState* sat_state) {
 
 Lit* get_free_literal_from_clause(Clause* c) {
 	for (unsigned int i = 0; i < c->num_lits; i++) {
-		if (c->literals[i]->var->status == free_var) {
+		if (*c->literals[i]->value == 0) {
 			return c->literals[i];
 		}
 	}
 	return NULL;
 }
 
-LitNode* append(LitNode* head, LitNode* n) {
-	LitNode* tmp = head;
-	if (tmp != NULL) {
-		while (tmp->next != NULL)
-			tmp = tmp->next;
-		tmp->next = n;
-		return head;
+//returns the current decision level: 1 before any decision, then one more per decision
+void push_trail(SatState* sat_state, Lit* lit) {
+	sat_state->trail[sat_state->trail_size++] = lit;
+}
+
+// opens a new decision level at the end of the trail, with lit decided at it
+// unit resolution is left to the caller
+void open_decision_level(SatState* sat_state, Lit* lit) {
+	sat_state->level_starts[sat_state->num_decisions] = sat_state->trail_size;
+	sat_state->num_decisions += 1;
+	c2dSize v = lit->var->index;
+	sat_state->levels[v] = sat_decision_level(sat_state);
+	sat_state->reasons[v] = NULL;
+	sat_state->binary_reasons[v] = NULL;
+	assign_literal(lit);
+	push_trail(sat_state, lit);
+}
+
+// sets lit to true at the given level because of reason, and pushes it on the
+// trail, where unit resolution will mark it
+void imply_literal(SatState* sat_state, Lit* lit, Clause* reason, c2dSize level) {
+	c2dSize v = lit_var_index(sat_state, lit);
+	sat_state->levels[v] = level;
+	sat_state->reasons[v] = reason;
+	sat_state->binary_reasons[v] = NULL;
+	assign_literal(lit);
+	push_trail(sat_state, lit);
+}
+
+// same as imply_literal for a binary clause, whose reason is only its false literal
+void imply_literal_binary(SatState* sat_state, Lit* lit, Lit* false_lit, c2dSize level) {
+	c2dSize v = lit_var_index(sat_state, lit);
+	sat_state->levels[v] = level;
+	sat_state->reasons[v] = NULL;
+	sat_state->binary_reasons[v] = false_lit;
+	assign_literal(lit);
+	push_trail(sat_state, lit);
+}
+
+// sets the literal to true
+// every original clause mentioning it gains a subsuming literal, and the vars
+// of a clause that just became subsumed lose an unsubsumed clause
+void assign_literal(Lit* lit) {
+	lit->var->status = (lit->index > 0) ? implied_pos : implied_neg;
+	*lit->value = 1;
+	*flip_lit(lit)->value = -1;
+	SatState* sat_state = lit->var->state;
+	c2dSize code = lit_code(sat_state, lit);
+	Clause** end = sat_state->occurrences + sat_state->occ_offsets[code + 1];
+	for (Clause** o = sat_state->occurrences + sat_state->occ_offsets[code]; o != end; o++) {
+		Clause* c = *o;
+		if (c->subsuming_literal_count++ == 0) {
+			for (c2dSize i = 0; i < c->num_lits; i++)
+				c->literals[i]->var->unsubsumed_clause_count--;
+		}
 	}
-	else { // just one
-		return n;
+}
+
+// frees the variable of a true literal, reverting assign_literal()
+void unassign_literal(Lit* lit) {
+	if (!is_lit_true(lit))
+		return;
+	lit->var->status = free_var;
+	*lit->var->pos_lit->value = 0;
+	*lit->var->neg_lit->value = 0;
+	SatState* sat_state = lit->var->state;
+	sat_state->saved_phases[lit->var->index] = (lit == lit->var->pos_lit ? 1 : -1);
+	if (sat_state->heap_positions[lit->var->index] == not_in_heap)
+		heap_insert(sat_state, lit->var->index);
+	c2dSize code = lit_code(sat_state, lit);
+	Clause** end = sat_state->occurrences + sat_state->occ_offsets[code + 1];
+	for (Clause** o = sat_state->occurrences + sat_state->occ_offsets[code]; o != end; o++) {
+		Clause* c = *o;
+		if (--c->subsuming_literal_count == 0) {
+			for (c2dSize i = 0; i < c->num_lits; i++)
+				c->literals[i]->var->unsubsumed_clause_count++;
+		}
 	}
 }
 
+// code of a literal, which is its place in the literal block:
+// 2v for the positive literal of var v, 2v+1 for the negative one
+c2dSize lit_code(const SatState* sat_state, const Lit* lit) {
+	return (c2dSize)(lit - sat_state->lits);
+}
 
-// return true if no conflict
-// else return false and assign a clause to conflict reason
-BOOLEAN mark_a_literal(SatState* sat_state, Lit* lit) {
-	// return true;
-	
-	//printstuff(sat_state);
-	if (lit->index > 0) {
-		lit->var->status = implied_pos;
-	}
-	else {
-		lit->var->status = implied_neg;
+// index of the var of a literal, found from its place in the literal block
+c2dSize lit_var_index(const SatState* sat_state, const Lit* lit) {
+	return lit_code(sat_state, lit) >> 1;
+}
+
+c2dSize lit_level(const SatState* sat_state, const Lit* lit) {
+	return sat_state->levels[lit_var_index(sat_state, lit)];
+}
+
+BOOLEAN is_lit_true(const Lit* lit) {
+	return *lit->value > 0;
+}
+
+BOOLEAN is_lit_false(const Lit* lit) {
+	return *lit->value < 0;
+}
+
+// rank of a literal as a watch: non-false literals first,
+// then false literals by decreasing level
+c2dSize watch_rank(const SatState* sat_state, const Lit* lit) {
+	return is_lit_false(lit) ? lit_level(sat_state, lit) : (c2dSize)-1;
+}
+
+// picks the two best ranked literals of the clause as its watches and adds the
+// clause to their watch lists
+// for an asserting clause this is its free literal and the false literal at the
+// assertion level
+void watch_clause(SatState* sat_state, Clause* c) {
+	Lit* w1 = NULL;
+	Lit* w2 = NULL;
+	for (c2dSize i = 0; i < c->num_lits; i++) {
+		Lit* l = c->literals[i];
+		if (l == w1 || l == w2)
+			continue;
+		if (w1 == NULL || watch_rank(sat_state, l) > watch_rank(sat_state, w1)) {
+			w2 = w1;
+			w1 = l;
+		}
+		else if (w2 == NULL || watch_rank(sat_state, l) > watch_rank(sat_state, w2)) {
+			w2 = l;
+		}
 	}
-	if (lit->var->ticket == 0)
-	{
-		print_sat_state_clauses(sat_state);
-		printf("\nLit %d got implied in mark_a_literal but didn't get ticket!\n", lit->index);
-		getc(stdin);
+	// a unit clause is never watched
+	if (w2 == NULL)
+		return;
+	// a binary clause is found from the binary watches of both its literals
+	if (c->num_lits == 2) {
+		add_BinaryWatch(&(w1->binary_watches), w2, c);
+		add_BinaryWatch(&(w2->binary_watches), w1, c);
+		return;
 	}
+	c->watch1 = w1;
+	c->watch2 = w2;
+	add(&(w1->watched_clauses), c);
+	add(&(w2->watched_clauses), c);
+}
 
-	ClauseNode* resolved_head = flip_lit(lit)->clauses;
-	while (resolved_head != NULL) {
-		if (count_subsumed_lit(resolved_head->clause) == 0 &&
-			count_free_lit(resolved_head->clause) == 0) {//conflict
-			sat_state->conflict_reason = resolved_head->clause;
-			return false;
+
+// return true if no conflict
+// else return false and assign a clause to conflict reason
+//
+// only the clauses watching the negation of lit are visited: each one either
+// moves that watch to a non-false literal, or is unit/conflicting on its other watch
+BOOLEAN mark_a_literal(SatState* sat_state, Lit* lit) {
+	Lit* false_lit = flip_lit(lit);
+	c2dSize level = lit_level(sat_state, lit);
+	ClausePtrVector* watchers = &(false_lit->watched_clauses);
+	Clause** w = watchers->clause;
+	size_t size = watchers->current;
+	size_t i = 0;
+	size_t j = 0; // clauses kept in the list are compacted to the front
+
+	while (i < size) {
+		Clause* c = w[i++];
+		Lit* other = (c->watch1 == false_lit) ? c->watch2 : c->watch1;
+
+		// clause already subsumed by its other watch
+		if (is_lit_true(other)) {
+			w[j++] = c;
+			continue;
 		}
-		else if (count_subsumed_lit(resolved_head->clause) == 0 &&
-			count_free_lit(resolved_head->clause) == 1){
 
-			Lit* new_implied = get_free_literal_from_clause(resolved_head->clause);
+		// look for a non-false literal to watch instead of false_lit
+		Lit* replacement = NULL;
+		for (c2dSize k = 0; k < c->num_lits; k++) {
+			Lit* l = c->literals[k];
+			if (l != c->watch1 && l != c->watch2 && !is_lit_false(l)) {
+				replacement = l;
+				break;
+			}
+		}
+		if (replacement != NULL) {
+			if (c->watch1 == false_lit)
+				c->watch1 = replacement;
+			else
+				c->watch2 = replacement;
+			add(&(replacement->watched_clauses), c);
+			continue;
+		}
 
-			new_implied->var->level = lit->var->level;
+		w[j++] = c;
 
-			// set level
-			// add the newly implied literal
-			LitNode* lnode = (LitNode*)malloc(sizeof(LitNode));
-			initialize_LitNode(lnode);
-			if (new_implied->var->level == 1)
-			{
-				//print_sat_state_clauses(sat_state);
-				//printf("\n\nReason for this is: %d", sat_state->call_stat);
-				//printf("\n\nCalled get_ticket_number with %d(Implied by %d<%d>[%d](%d)) at level 1\n", new_implied->index, lit->index, lit->var->level, lit->var->ticket, lit->var->status);
-				//getc(stdin);
-			}
-			get_ticket_number(new_implied->var, sat_state);
-			lnode->lit = new_implied;
-			lnode->lit->var->status = (lnode->lit->index>0) ? implied_pos : implied_neg;
-			lnode->lit->reason = resolved_head->clause;
-			sat_state->implied_literals = append(sat_state->implied_literals, lnode);
+		if (is_lit_false(other)) {//conflict
+			while (i < size)
+				w[j++] = w[i++];
+			watchers->current = j;
+			sat_state->conflict_reason = c;
+			return false;
 		}
-		resolved_head = resolved_head->next;
+
+		// unit: the other watch is the only free literal left
+		imply_literal(sat_state, other, c, level);
 	}
+	watchers->current = j;
 
 	return true;
 }
 
-void unmark_a_literal(SatState* sat_state, Lit* lit) {
-	ClauseNode* resolved_head = flip_lit(lit)->clauses;
-	while (resolved_head != NULL) {
-		resolved_head = resolved_head->next;
+// return true if no conflict
+// else return false and assign a clause to conflict reason
+//
+// implies the other literal of every binary clause of the negation of lit
+BOOLEAN propagate_binary(SatState* sat_state, Lit* lit) {
+	Lit* false_lit = flip_lit(lit);
+	c2dSize level = lit_level(sat_state, lit);
+	BinaryWatch* w = false_lit->binary_watches.watches;
+	BinaryWatch* end = w + false_lit->binary_watches.current;
+	for (; w != end; w++) {
+		Lit* other = w->other;
+		if (is_lit_true(other))
+			continue;
+		if (is_lit_false(other)) {//conflict
+			sat_state->conflict_reason = w->clause;
+			return false;
+		}
+		imply_literal_binary(sat_state, other, false_lit, level);
 	}
-	lit->reason = NULL;
-	lit->var->status = free_var;
-	
+	return true;
+}
+
+// releases a literal popped from the trail: its var becomes free again at level 1
+void unmark_a_literal(SatState* sat_state, Lit* lit) {
+	unassign_literal(lit);
+	c2dSize v = lit_var_index(sat_state, lit);
+	sat_state->reasons[v] = NULL;
+	sat_state->binary_reasons[v] = NULL;
+	sat_state->levels[v] = 1;
 }
 
-c2dSize get_last_level(Clause* reason) {
+c2dSize get_last_level(SatState* sat_state, Clause* reason) {
   c2dSize last_level = 0;
   for (unsigned long i = 0; i < reason->num_lits; i++) {
-    if (reason->literals[i]->var->level >  last_level) {
-      last_level = reason->literals[i]->var->level;
+    if (lit_level(sat_state, reason->literals[i]) >  last_level) {
+      last_level = lit_level(sat_state, reason->literals[i]);
     }
   }
   return last_level;
@@ -893,6 +1321,9 @@ c2dSize get_last_level(Clause* reason) {
 
 //applies unit resolution to the cnf of sat state
 //returns 1 if unit resolution succeeds, 0 if it finds a contradiction
+//
+//the literals on the trail from prop_head onwards have been assigned but not
+//marked yet; marking them may push new implied literals at the end of the trail
 BOOLEAN sat_unit_resolution(SatState* sat_state) {
 	// Test: Check the status of variable 20
 	//printstuff(sat_state);
@@ -903,121 +1334,65 @@ BOOLEAN sat_unit_resolution(SatState* sat_state) {
 		//getc(stdin);
 		exit(1);
 	}
+	if (sat_state->stopped)
+		return 0;
 	if (sat_state->call_stat == first_call) {
-		if (sat_state->conflict_reason != NULL)
+		if (sat_state->conflict_reason != NULL || sat_state->empty_clause)
 		{
 			return false;
 		}
 
-		LitNode* tmp = sat_state->implied_literals;
-		while (tmp != NULL) {
-			if (tmp->lit->var->ticket == 0)
-			{
-				printf("Marking a non-ticketed literal %d in first_call unit res\n", tmp->lit->index);
-				getc(stdin);
-			}
-			if (!mark_a_literal(sat_state, tmp->lit)) {
-				return 0;
+		// Imply the literals of unit clauses at level 1
+		// A unit clause whose literal is already false is a contradiction
+		for (size_t i = 0; i < sat_state->unit_clauses.current; i++) {
+			Clause* unit = sat_state->unit_clauses.clause[i];
+			Lit* unit_lit = unit->literals[0];
+			if (is_lit_true(unit_lit))
+				continue;
+			if (is_lit_false(unit_lit)) {
+				sat_state->conflict_reason = unit;
+				return false;
 			}
-			tmp = tmp->next;
+			imply_literal(sat_state, unit_lit, unit, 1);
 		}
 		//print_sat_state_clauses(sat_state);
 	}
-	else if (sat_state->call_stat == decide_call) { // mark on a decision
-		LitNode* tmp = sat_state->implied_literals;
-
-		if (tmp != NULL) {
-			while (tmp->next != NULL)
-				tmp = tmp->next;
-		}
-
-		// bug
-		if (sat_state->decided_literals->lit->var->ticket == 0)
-		{
-			printf("Marking a non-ticketed literal %d in decide_call unit res\n", sat_state->decided_literals->lit->index);
-			getc(stdin);
-		}
-		if (!mark_a_literal(sat_state, sat_state->decided_literals->lit)) {
-			return false;
-		}
-		// if originally no implied
-		if (tmp == NULL) {
-			tmp = sat_state->implied_literals;
-		}
-		else {
-			tmp = tmp->next;
-		}
-		while (tmp != NULL) {
-			if (tmp->lit->var->ticket == 0)
-			{
-				printf("Marking a non-ticketed literal %d in decide_call unit res\n", tmp->lit->index);
-				getc(stdin);
-			}
-			if (!mark_a_literal(sat_state, tmp->lit)) {
+	else if (sat_state->call_stat == learn_call) {
+		Clause* c = sat_state->asserted_clause;
+
+		// the learned clause is watched on its free literal, so it is only
+		// unit here; implying that literal is the one step not driven by a watch
+		// it is implied at the current level, which keeps the trail in level order:
+		// a clause of the cnf asserted for a learned one it subsumes (see
+		// sat_assert_clause) can have all its false literals below that level
+		Lit* going_to_mark = get_free_literal_from_clause(c);
+		if (going_to_mark == NULL) {
+			if (count_subsumed_lit(c) == 0) { // conflict
+				sat_state->conflict_reason = c;
 				return 0;
 			}
-			tmp = tmp->next;
 		}
-		return 1;
+		else if (count_subsumed_lit(c) == 0 && count_free_lit(c) == 1) { // new imply
+			imply_literal(sat_state, going_to_mark, c, sat_state->num_decisions + 1);
+		}
 	}
-	else if (sat_state->call_stat == learn_call) {
-		//printf("Learned call\n");
-
-		Clause* c = sat_state->cnf_tail->clause;
-		//print_clause(c);
-		//printf("Num free: %d, Num subsume: %d\n", count_free_lit(c), count_subsumed_lit(c));
 
-		if (count_subsumed_lit(c) != 0 && count_free_lit(c) == 0){ // conflict
-			printf("Learned clause is conflicting!!!!\n");
-			sat_state->conflict_reason = c;
+	// Mark the assigned literals in trail order
+	// the binary clauses of every assigned literal are visited before the
+	// longer clauses of the next one
+	while (sat_state->prop_head < sat_state->trail_size) {
+		while (sat_state->binary_head < sat_state->trail_size) {
+			if (!propagate_binary(sat_state, sat_state->trail[sat_state->binary_head++]))
+				return 0;
+		}
+		sat_state->num_propagations += 1;
+		if (budget_exhausted(sat_state)) {
+			sat_state->stopped = true;
 			return 0;
 		}
-		else if (count_subsumed_lit(c) == 0 && count_free_lit(c) == 1) { // new imply
-			LitNode* tmp = sat_state->implied_literals;
-			// tmp is now the tail;
-			if (tmp != NULL) {
-				while (tmp->next != NULL)
-					tmp = tmp->next;
-			}
-			//printf("Learned clause implies literal...%d\n", get_free_literal_from_clause(c)->index);
-
-			Lit* going_to_mark = get_free_literal_from_clause(c);
-			going_to_mark->var->level = get_last_level(c);
-			going_to_mark->reason = c;
-			
-			// Get ticket number and add to implied literal queue in sat_state
-			get_ticket_number(going_to_mark->var, sat_state);
-			LitNode* going_to_mark_node = (LitNode*)malloc(sizeof(LitNode));
-			initialize_LitNode(going_to_mark_node);
-			going_to_mark_node->lit = going_to_mark;
-			sat_state->implied_literals = append(sat_state->implied_literals, going_to_mark_node);
-			
-			if (going_to_mark->var->ticket == 0)
-			{
-				printf("Marking a non-ticketed literal %d in learned_call unit res\n", going_to_mark->index);
-				getc(stdin);
-			}
-			
-			if (!mark_a_literal(sat_state, going_to_mark)){
-				return 0;
-			}
-			if (tmp == NULL) {
-				tmp = sat_state->implied_literals;
-			}
-			else {
-				tmp = tmp->next;
-			}
-			while (tmp != NULL) {
-				if (tmp->lit->var->ticket == 0)
-				{
-					printf("Marking a non-ticketed literal %d in first_call unit res\n", tmp->lit->index);
-					getc(stdin);
-				}
-				if (!mark_a_literal(sat_state, tmp->lit)) {
-					return 0;
-				}
-				tmp = tmp->next;
-			}
+		Lit* lit = sat_state->trail[sat_state->prop_head++];
+		if (!mark_a_literal(sat_state, lit)) {
+			return 0;
 		}
 	}
 	return 1;
@@ -1026,16 +1401,15 @@ BOOLEAN sat_unit_resolution(SatState* sat_state) {
 //undoes sat_unit_resolution(), leading to un-instantiating variables that have been instantiated
 //after sat_unit_resolution()
 void sat_undo_unit_resolution(SatState* sat_state) {
-	LitNode* decided = sat_state->decided_literals;
-	LitNode* implied = sat_state->implied_literals;
-	while (decided != NULL) {
-		decided->lit->var->status = free_var;
-		decided = decided->next;
-	}
-	while (implied != NULL) {
-		implied->lit->var->status = free_var;
-		implied = implied->next;
+	while (sat_state->trail_size > 0) {
+		Lit* lit = sat_state->trail[--sat_state->trail_size];
+		unmark_a_literal(sat_state, lit);
 	}
+	sat_state->prop_head = 0;
+	sat_state->binary_head = 0;
+	sat_state->num_decisions = 0;
+	sat_state->conflict_reason = NULL;
+	sat_state->call_stat = first_call;
 	return;
 }
 
@@ -1045,14 +1419,14 @@ void sat_undo_unit_resolution(SatState* sat_state) {
 //this function is called after sat_decide_literal() or sat_assert_clause() returns clause.
 //it is used to decide whether the sat state is at the right decision level for adding clause.
 BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state) {
+	// the clause returned once stopped is never asserted
+	if (sat_state->stopped)
+		return 0;
+
 	// Assume clause isn't NULL and has more than 0 literal
 	assert(clause != NULL && clause->num_lits > 0);
 
-	c2dSize decision_level;
-	if (sat_state->decided_literals == NULL)
-		decision_level = 1;
-	else
-		decision_level = sat_state->decided_literals->lit->var->level;
+	c2dSize decision_level = sat_decision_level(sat_state);
 
 	//if (clause->num_lits == 1)
 	//	return (1 == decision_level);
@@ -1063,16 +1437,16 @@ BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state)
 	//// get highest level
 	//for (unsigned int i = 0; i < clause->num_lits; i++)
 	//{
-	//	if ((clause->literals[i]->var->level)>highest_level)
-	//		highest_level = (clause->literals[i]->var->level);
+	//	if (lit_level(sat_state, clause->literals[i])>highest_level)
+	//		highest_level = lit_level(sat_state, clause->literals[i]);
 	//}
 
 	//// get assertion_level
 	//for (unsigned int i = 0; i < clause->num_lits; i++)
 	//{
-	//	if (((clause->literals[i]->var->level)>assertion_level)
-	//		&& ((clause->literals[i]->var->level) != highest_level))
-	//		assertion_level = (clause->literals[i]->var->level);
+	//	if ((lit_level(sat_state, clause->literals[i])>assertion_level)
+	//		&& (lit_level(sat_state, clause->literals[i]) != highest_level))
+	//		assertion_level = lit_level(sat_state, clause->literals[i]);
 	//}
 	//return decision_level == assertion_level;	
 	//
@@ -1082,6 +1456,168 @@ BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state)
 
 }
 
+//returns the decision level of the sat state, 1 when nothing is decided
+c2dSize sat_decision_level(const SatState* sat_state) {
+	return sat_state->num_decisions + 1;
+}
+
+//returns the assertion level of clause, which must be the one returned last by
+//sat_decide_literal() or sat_assert_clause()
+c2dSize sat_assertion_level(const Clause* clause, const SatState* sat_state) {
+	assert(clause != NULL);
+	return sat_state->assertion_level;
+}
+
+static const char* restart_mode_names[] = { "none", "luby", "glucose" };
+
+//sets when sat_restart_due() asks for a restart, by name:
+//  none: never
+//  luby: after luby_unit times the terms of the luby sequence (1 1 2 1 1 2 4 ...) conflicts
+//  glucose: when the recent learned clauses have a much larger LBD than the average
+//  (the default)
+//returns 0 if there is no such mode, 1 otherwise
+BOOLEAN sat_set_restart_mode(SatState* sat_state, const char* mode) {
+	for (int m = restart_none; m <= restart_glucose; m++) {
+		if (strcmp(mode, restart_mode_names[m]) == 0) {
+			sat_state->restart_mode = m;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+//returns 1 if the search should restart now, 0 otherwise
+//
+//a 1 is counted as a restart, and the schedule moves on; the caller is expected
+//to restart by sat_backtrack_to_level(1, sat_state)
+BOOLEAN sat_restart_due(SatState* sat_state) {
+	BOOLEAN due = 0;
+	if (sat_state->restart_mode == restart_luby)
+		due = sat_state->conflicts_since_restart >= luby_unit * luby(sat_state->num_restarts + 1);
+	else if (sat_state->restart_mode == restart_glucose)
+		due = sat_state->conflicts_since_restart >= glucose_min_conflicts
+			&& sat_state->lbd_ema_fast > glucose_margin * sat_state->lbd_ema_slow;
+	if (due) {
+		sat_state->num_restarts += 1;
+		sat_state->conflicts_since_restart = 0;
+	}
+	return due;
+}
+
+//returns the number of restarts asked for by sat_restart_due()
+c2dSize sat_restart_count(const SatState* sat_state) {
+	return sat_state->num_restarts;
+}
+
+//sets the budgets of the search from now on, 0 for no limit: it can have that
+//many more conflicts and propagated literals, run for that many more seconds, and
+//stops once its learned clauses take that many megabytes
+//clears the stopped state of sat state, and an interruption that led to it
+void sat_set_budget(SatState* sat_state, c2dSize conflicts, c2dSize propagations, double seconds, c2dSize megabytes) {
+	sat_state->conflict_limit = (conflicts > 0 ? sat_state->num_conflicts + conflicts : 0);
+	sat_state->propagation_limit = (propagations > 0 ? sat_state->num_propagations + propagations : 0);
+	sat_state->deadline = (seconds > 0 ? monotonic_seconds() + seconds : 0);
+	sat_state->memory_limit = megabytes * 1024 * 1024;
+	__atomic_store_n(&sat_state->interrupt_requested, 0, __ATOMIC_RELAXED);
+	sat_state->stopped = false;
+}
+
+//asks unit resolution on sat state to stop as soon as it can: it looks at the
+//request before marking each literal
+//the request is a single atomic store, so any thread or a signal handler can make it
+void sat_interrupt(SatState* sat_state) {
+	__atomic_store_n(&sat_state->interrupt_requested, 1, __ATOMIC_RELAXED);
+}
+
+//returns 1 if unit resolution was stopped by a budget or sat_interrupt(), 0 otherwise
+BOOLEAN sat_stopped(const SatState* sat_state) {
+	return sat_state->stopped;
+}
+
+//decides whether the cnf of sat state is satisfiable when the assumptions are all
+//true; returns 1 if it is, 0 otherwise
+//
+//the assumptions are decided before any other literal, again after each backjump
+//and restart, so the decisions below the last assumption are all assumptions.
+//an assumption found false is thus implied false by the assumptions before it,
+//and these make the final conflict (see sat_final_conflict)
+//
+//the learned clauses stay in the sat state, so each call starts from what the
+//previous ones learned. if 1 is returned the satisfying assignment is left on the
+//sat state, and the next call (or sat_undo_unit_resolution) undoes it
+//
+//result_unknown is returned if a budget runs out or sat_interrupt() is called
+BOOLEAN sat_solve_assumptions(SatState* sat_state, const c2dLiteral* assumptions, c2dSize num_assumptions) {
+	sat_state->final_conflict_size = 0;
+	sat_undo_unit_resolution(sat_state);
+	if (!sat_unit_resolution(sat_state)) {
+		sat_undo_unit_resolution(sat_state);
+		return sat_state->stopped ? result_unknown : 0;
+	}
+
+	for (;;) {
+		BOOLEAN refuted = false;
+		Lit* lit = next_assumption(sat_state, assumptions, num_assumptions, &refuted);
+		if (refuted) {
+			analyze_final(sat_state, lit);
+			sat_undo_unit_resolution(sat_state);
+			return 0;
+		}
+		if (lit == NULL)
+			lit = sat_pick_branch_literal(sat_state);
+		if (lit == NULL)
+			return 1; // all literals are implied
+
+		Clause* learned = sat_decide_literal(lit, sat_state);
+		if (learned != NULL) {
+			BOOLEAN asserted = assert_learned_clause(learned, sat_state);
+			if (asserted != 1) {
+				sat_undo_unit_resolution(sat_state);
+				return asserted;
+			}
+			if (sat_restart_due(sat_state))
+				sat_backtrack_to_level(1, sat_state);
+		}
+	}
+}
+
+//returns the assumptions found contradictory by the last sat_solve_assumptions()
+//which returned 0, and sets *size to their number: an assumption which is false,
+//and those it follows from, so the cnf implies that they are not all true
+//*size is 0 when the cnf is unsatisfiable without assumptions
+const c2dLiteral* sat_final_conflict(const SatState* sat_state, c2dSize* size) {
+	*size = sat_state->final_conflict_size;
+	return sat_state->final_conflict;
+}
+
+//makes sat state write a binary DRAT proof from now on: each clause added by
+//sat_assert_clause() and each one deleted by a reduction is encoded into buffer,
+//which is handed to flush, with sink, whenever it fills up
+//the flush function returns the buffer to go on with, so the caller can keep
+//several and write out the full ones while the search goes on
+void sat_set_proof(SatState* sat_state, ProofFlush flush, void* sink, unsigned char* buffer, size_t capacity) {
+	assert(capacity >= 2 * proof_lit_bytes);
+	sat_state->proof_flush = flush;
+	sat_state->proof_sink = sink;
+	sat_state->proof_buffer = buffer;
+	sat_state->proof_size = 0;
+	sat_state->proof_capacity = capacity;
+}
+
+//ends the proof of sat state, adding the empty clause if the cnf is unsatisfiable
+//(unit resolution on the clauses of the proof then finds a contradiction), and
+//flushes the rest of it; nothing more is written to the proof after that
+void sat_end_proof(SatState* sat_state, BOOLEAN unsatisfiable) {
+	if (sat_state->proof_flush == NULL)
+		return;
+	if (unsatisfiable)
+		proof_clause(sat_state, 'a', NULL, 0);
+	sat_state->proof_flush(sat_state->proof_sink, sat_state->proof_buffer, sat_state->proof_size);
+	sat_state->proof_flush = NULL;
+	sat_state->proof_buffer = NULL;
+	sat_state->proof_size = 0;
+}
+
 /******************************************************************************
 * The functions below are already implemented for you and MUST STAY AS IS
 ******************************************************************************/
@@ -1124,43 +1660,136 @@ void sat_unmark_clause(Clause* clause) {
 * Added function
 ******************************************************************************/
 
-void get_ticket_number(Var* v, SatState* sat_state)
-{
-	/*if (v->level == 1)
-	{
-		v->ticket = sat_state->ticket_number;
-		print_sat_state_clauses(sat_state);
-		printf(" %d<%d>[%d] ", v->index, v->level, v->ticket);
-		getc(stdin);
+// Variable activities, and the heap of variables ordered by activity
+// heap[0] has the highest activity; heap_positions[v] is the place of v in heap
 
-	}*/
+BOOLEAN heap_before(const SatState* sat_state, uint32_t v1, uint32_t v2) {
+	return sat_state->activity[v1] > sat_state->activity[v2];
+}
 
-	v->ticket = sat_state->ticket_number;
-	if (sat_state->ticket_number == 0)
-	{
-		printf("\nTicket num = 0!!!!!!");
-		getc(stdin);
+void heap_up(SatState* sat_state, uint32_t pos) {
+	uint32_t* heap = sat_state->heap;
+	uint32_t v = heap[pos];
+	while (pos > 0) {
+		uint32_t parent = (pos - 1) / 2;
+		if (!heap_before(sat_state, v, heap[parent]))
+			break;
+		heap[pos] = heap[parent];
+		sat_state->heap_positions[heap[pos]] = pos;
+		pos = parent;
 	}
-	//printf(" %d<%d>[%d] ", v->index, v->level, v->ticket);
-	sat_state->ticket_number += 1;
+	heap[pos] = v;
+	sat_state->heap_positions[v] = pos;
+}
+
+void heap_down(SatState* sat_state, uint32_t pos) {
+	uint32_t* heap = sat_state->heap;
+	uint32_t v = heap[pos];
+	for (;;) {
+		uint32_t child = 2 * pos + 1;
+		if (child >= sat_state->heap_size)
+			break;
+		if (child + 1 < sat_state->heap_size && heap_before(sat_state, heap[child + 1], heap[child]))
+			child++;
+		if (!heap_before(sat_state, heap[child], v))
+			break;
+		heap[pos] = heap[child];
+		sat_state->heap_positions[heap[pos]] = pos;
+		pos = child;
+	}
+	heap[pos] = v;
+	sat_state->heap_positions[v] = pos;
 }
 
-void unget_ticket_number(Var* v, SatState* sat_state)
-{
-	v->ticket = 0;
-	v->status = free_var;
-	//sat_state->ticket_number -= 1;
+void heap_insert(SatState* sat_state, c2dSize v) {
+	uint32_t pos = sat_state->heap_size++;
+	sat_state->heap[pos] = (uint32_t)v;
+	heap_up(sat_state, pos);
+}
+
+c2dSize heap_pop(SatState* sat_state) {
+	uint32_t* heap = sat_state->heap;
+	uint32_t top = heap[0];
+	sat_state->heap_positions[top] = not_in_heap;
+	if (--sat_state->heap_size > 0) {
+		heap[0] = heap[sat_state->heap_size];
+		heap_down(sat_state, 0);
+	}
+	return top;
+}
+
+void bump_var_activity(SatState* sat_state, c2dSize v) {
+	if ((sat_state->activity[v] += sat_state->activity_inc) > activity_limit) {
+		// scale everything down, which keeps the order
+		for (c2dSize u = 1; u <= sat_state->num_vars; u++)
+			sat_state->activity[u] /= activity_limit;
+		sat_state->activity_inc /= activity_limit;
+	}
+	if (sat_state->heap_positions[v] != not_in_heap)
+		heap_up(sat_state, sat_state->heap_positions[v]);
+}
+
+// makes the next bumps count more than the previous ones
+void decay_var_activity(SatState* sat_state) {
+	sat_state->activity_inc /= activity_decay;
+}
+
+// decides lit and undoes it again
+// returns the number of literals that were implied (lit included), -1 if unit
+// resolution found a contradiction
+//
+// a contradiction is not analyzed, so probing leaves the conflict count (and its
+// budget), the var activities and the restart averages as they were; the
+// literals it propagates are not counted either
+long probe_literal(SatState* sat_state, Lit* lit) {
+	uint32_t trail_size = sat_state->trail_size;
+	c2dSize num_propagations = sat_state->num_propagations;
+	open_decision_level(sat_state, lit);
+	sat_state->call_stat = decide_call;
+	BOOLEAN consistent = sat_unit_resolution(sat_state);
+	long implied = (long)(sat_state->trail_size - trail_size);
+	sat_undo_decide_literal(sat_state);
+	sat_state->conflict_reason = NULL;
+	sat_state->num_propagations = num_propagations;
+	// once stopped, what lookahead finds does not matter
+	if (consistent || sat_state->stopped)
+		return implied;
+	return -1;
+}
+
+// Saved phases
+
+// keeps the phases of the current trail, the longest one so far
+void save_best_phases(SatState* sat_state) {
+	for (uint32_t i = 0; i < sat_state->trail_size; i++) {
+		Lit* lit = sat_state->trail[i];
+		sat_state->best_phases[lit->var->index] = (lit == lit->var->pos_lit ? 1 : -1);
+	}
+	sat_state->best_trail_size = sat_state->trail_size;
+}
+
+// resets the saved phases as the phase mode says, and schedules the next reset
+void rephase(SatState* sat_state) {
+	for (c2dSize v = 1; v <= sat_state->num_vars; v++) {
+		if (sat_state->phase_mode == phase_original)
+			sat_state->saved_phases[v] = 1;
+		else if (sat_state->phase_mode == phase_inverted)
+			sat_state->saved_phases[v] = -1;
+		else if (sat_state->best_phases[v] != 0)
+			sat_state->saved_phases[v] = sat_state->best_phases[v];
+	}
+	sat_state->rephase_interval += rephase_increment;
+	sat_state->next_rephase = sat_state->num_conflicts + sat_state->rephase_interval;
 }
 
 void initialize_Lit(Lit* l) {
 	l->index = 1;
-	l->clauses = NULL;
-	l->clauses_tail = NULL;
 	l->var = NULL;
-	l->reason = NULL;
+	l->value = NULL;
+	initialize_ClausePtrVector(&l->watched_clauses);
+	initialize_BinaryWatchVector(&l->binary_watches);
 }
 
-void initialize_LitNode(LitNode* l) { l->lit = NULL; l->next = NULL; }
 
 void add(ClausePtrVector* cv, Clause* c)
 {
@@ -1170,7 +1799,7 @@ void add(ClausePtrVector* cv, Clause* c)
 	}
 	else if (cv->current == cv->limit)
 	{
-		cv->limit += 2;
+		cv->limit *= 2;
 		cv->clause = (Clause**)realloc(cv->clause, cv->limit*sizeof(Clause*));
 		if (cv->clause == NULL)
 		{
@@ -1191,7 +1820,7 @@ void add_LitPtrVector(LitPtrVector* lv, Lit* l)
 	}
 	else if (lv->current == lv->limit)
 	{
-		lv->limit += 2;
+		lv->limit *= 2;
 		lv->lits = (Lit**)realloc(lv->lits, lv->limit*sizeof(Lit*));
 		if (lv->lits == NULL)
 		{
@@ -1206,6 +1835,33 @@ void add_LitPtrVector(LitPtrVector* lv, Lit* l)
 }
 
 
+void add_BinaryWatch(BinaryWatchVector* bv, Lit* other, Clause* c)
+{
+	if (bv->watches == NULL)
+	{
+		bv->watches = (BinaryWatch*)malloc(bv->limit*sizeof(BinaryWatch));
+	}
+	else if (bv->current == bv->limit)
+	{
+		bv->limit *= 2;
+		bv->watches = (BinaryWatch*)realloc(bv->watches, bv->limit*sizeof(BinaryWatch));
+		if (bv->watches == NULL)
+		{
+			exit(1);
+		}
+
+	}
+	bv->watches[bv->current].other = other;
+	bv->watches[bv->current].clause = c;
+	bv->current++;
+}
+
+void initialize_BinaryWatchVector(BinaryWatchVector* b) {
+	b->watches = NULL;
+	b->limit = 5;
+	b->current = 0;
+}
+
 void initialize_ClausePtrVector(ClausePtrVector* c) {
 	c->clause = NULL;
 	c->limit = 5;
@@ -1219,67 +1875,215 @@ void initialize_LitPtrVector(LitPtrVector* l) {
 }
 
 void initialize_Var(Var* v) {
-	v->pos_lit = (Lit*)malloc(sizeof(Lit));
-	v->neg_lit = (Lit*)malloc(sizeof(Lit));
-	initialize_Lit(v->pos_lit);
-	initialize_Lit(v->neg_lit);
+	v->pos_lit = NULL;
+	v->neg_lit = NULL;
 	v->status = free_var;
-	v->ticket = 0;
 	v->num_clause_has = 0;
+	v->unsubsumed_clause_count = 0;
 	v->state = NULL;
-	v->level = 1;
   v->mark = 0;
-	initialize_ClausePtrVector(&v->original_cnf_array);
 }
 
 void initialize_Clause(Clause * c) {
 	c->literals = NULL;
 	c->num_lits = 0;
-	// c->subsuming_literal_count = 0;
-	// c->free_literal_count = 0;
+	c->subsuming_literal_count = 0;
+	c->learned = false;
+	c->lbd = 0;
+	c->tier = tier_core;
+	c->used = false;
+	c->deleted = false;
+	c->hash = 0;
 	c->watch1 = NULL;
 	c->watch2 = NULL;
   c->mark = 0;
 }
 
-void initialize_ClauseNode(ClauseNode* c) {
-	c->next = NULL;
-	c->clause = NULL;
-}
-
 void initialize_SatState(SatState* s) {
 	s->vars = NULL;
 	s->num_vars = 0;
-	s->cnf_head = NULL;
-	s->cnf_tail = NULL;
+	s->clauses = NULL;
+	s->clause_literals = NULL;
 	s->num_orig_clauses = 0;
+	s->empty_clause = false;
+	s->occ_offsets = NULL;
+	s->occurrences = NULL;
+	initialize_ClausePtrVector(&s->learned_clauses);
 	s->num_asserted_clauses = 0;
 	s->assertion_level = 1;
-	s->decided_literals = NULL;
+	s->values = NULL;
+	s->lits = NULL;
+	s->levels = NULL;
+	s->reasons = NULL;
+	s->binary_reasons = NULL;
+	s->seen = NULL;
+	s->learned_lits = NULL;
+	s->minimize_stack = NULL;
+	s->minimize_to_clear = NULL;
+	s->learned_literal_count = 0;
+	s->minimized_literal_count = 0;
+	s->level_stamps = NULL;
+	s->lbd_stamp = 0;
+	s->activity = NULL;
+	s->activity_inc = 1;
+	s->heap = NULL;
+	s->heap_positions = NULL;
+	s->heap_size = 0;
+	s->num_conflicts = 0;
+	s->phase_mode = phase_saved;
+	s->saved_phases = NULL;
+	s->best_phases = NULL;
+	s->best_trail_size = 0;
+	s->next_rephase = rephase_first;
+	s->rephase_interval = rephase_first;
+	s->restart_mode = restart_glucose;
+	s->conflicts_since_restart = 0;
+	s->num_restarts = 0;
+	s->lbd_ema_fast = 0;
+	s->lbd_ema_slow = 0;
+	s->lit_stamps = NULL;
+	s->lit_stamp = 0;
+	initialize_ClauseHashSet(&s->clause_set);
+	s->asserted_clause = NULL;
+	s->duplicate_clause_count = 0;
+	s->next_reduction = reduce_first;
+	s->reduction_interval = reduce_first;
+	s->trail = NULL;
+	s->trail_size = 0;
+	s->prop_head = 0;
+	s->binary_head = 0;
+	s->level_starts = NULL;
+	s->num_decisions = 0;
 	s->conflict_reason = NULL;
-	s->implied_literals = NULL;
-	s->implied_literals_tail = NULL;
 	s->call_stat = first_call;
-	s->ticket_number = 1;
+	initialize_ClausePtrVector(&s->unit_clauses);
+	s->final_conflict = NULL;
+	s->final_conflict_size = 0;
+	s->conflict_limit = 0;
+	s->propagation_limit = 0;
+	s->deadline = 0;
+	s->memory_limit = 0;
+	s->learned_bytes = 0;
+	s->num_propagations = 0;
+	s->interrupt_requested = 0;
+	s->stopped = false;
+	initialize_Clause(&s->stop_clause);
+	s->proof_flush = NULL;
+	s->proof_sink = NULL;
+	s->proof_buffer = NULL;
+	s->proof_size = 0;
+	s->proof_capacity = 0;
+}
+
+// a well mixed 64 bit hash of the code of a literal
+uint64_t literal_hash(const SatState* sat_state, const Lit* lit) {
+	uint64_t x = (uint64_t)(lit - sat_state->lits) + 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// the same for any order of the literals
+uint64_t clause_hash(const SatState* sat_state, const Clause* c) {
+	uint64_t hash = 0;
+	for (c2dSize i = 0; i < c->num_lits; i++)
+		hash += literal_hash(sat_state, c->literals[i]);
+	return hash;
+}
+
+// marks a slot of the clause set whose clause was removed
+static Clause clause_set_tombstone;
+
+void initialize_ClauseHashSet(ClauseHashSet* set) {
+	set->slots = NULL;
+	set->capacity = 0;
+	set->size = 0;
+	set->filled = 0;
+}
+
+// rebuilds the table with room for twice the clauses, dropping tombstones
+void clause_set_grow(ClauseHashSet* set) {
+	Clause** old_slots = set->slots;
+	size_t old_capacity = set->capacity;
+	set->capacity = (old_capacity == 0) ? 1024 : 2 * old_capacity;
+	while (set->capacity < 4 * set->size)
+		set->capacity *= 2;
+	set->slots = (Clause**)calloc(set->capacity, sizeof(Clause*));
+	set->filled = set->size;
+	for (size_t i = 0; i < old_capacity; i++) {
+		Clause* c = old_slots[i];
+		if (c == NULL || c == &clause_set_tombstone)
+			continue;
+		size_t k = c->hash & (set->capacity - 1);
+		while (set->slots[k] != NULL)
+			k = (k + 1) & (set->capacity - 1);
+		set->slots[k] = c;
+	}
+	free(old_slots);
+}
+
+// linear probing, kept at most half full (tombstones included)
+void clause_set_insert(SatState* sat_state, Clause* c) {
+	ClauseHashSet* set = &(sat_state->clause_set);
+	if (2 * (set->filled + 1) > set->capacity)
+		clause_set_grow(set);
+	size_t k = c->hash & (set->capacity - 1);
+	while (set->slots[k] != NULL && set->slots[k] != &clause_set_tombstone)
+		k = (k + 1) & (set->capacity - 1);
+	if (set->slots[k] == NULL)
+		set->filled++;
+	set->slots[k] = c;
+	set->size++;
+}
+
+void clause_set_remove(SatState* sat_state, Clause* c) {
+	ClauseHashSet* set = &(sat_state->clause_set);
+	size_t k = c->hash & (set->capacity - 1);
+	while (set->slots[k] != NULL) {
+		if (set->slots[k] == c) {
+			set->slots[k] = &clause_set_tombstone;
+			set->size--;
+			return;
+		}
+		k = (k + 1) & (set->capacity - 1);
+	}
 }
 
-LitNode* append_node_LitNode(LitNode* node, LitNode* tail) {
-	if (tail != NULL) {
-		tail->next = node;
+// returns a clause of the set with the given hash and size, all of whose
+// literals are in superset; NULL if there is none
+Clause* clause_set_find(SatState* sat_state, uint64_t hash, c2dSize num_lits, Clause* superset) {
+	ClauseHashSet* set = &(sat_state->clause_set);
+	if (set->capacity == 0)
+		return NULL;
+	size_t k = hash & (set->capacity - 1);
+	while (set->slots[k] != NULL) {
+		Clause* c = set->slots[k];
+		if (c != &clause_set_tombstone && c->hash == hash && c->num_lits == num_lits
+			&& clause1_includes_clause2(sat_state, superset, c))
+			return c;
+		k = (k + 1) & (set->capacity - 1);
 	}
-	return node;
+	return NULL;
 }
 
-ClauseNode* append_node_ClauseNode(ClauseNode* node, ClauseNode* tail) {
-	if (tail != NULL) {
-		tail->next = node;
+// watches a clause of the cnf again, on the best literals for the current assignment
+// unit and binary clauses need no repair
+void rewatch_clause(SatState* sat_state, Clause* c) {
+	if (c->watch1 == NULL)
+		return;
+	Lit* watches[2] = { c->watch1, c->watch2 };
+	for (int w = 0; w < 2; w++) {
+		ClausePtrVector* watchers = &(watches[w]->watched_clauses);
+		for (size_t k = 0; k < watchers->current; k++) {
+			if (watchers->clause[k] == c) {
+				watchers->clause[k] = watchers->clause[--watchers->current];
+				break;
+			}
+		}
 	}
-	return node;
+	watch_clause(sat_state, c);
 }
 
-
-
-
 Lit* flip_lit(Lit* lit) {
 	if (lit->index > 0) {
 		return sat_neg_literal(lit->var);
@@ -1289,207 +2093,439 @@ Lit* flip_lit(Lit* lit) {
 	}
 }
 
-BOOLEAN is_lit_duplicate(LitNode* head, Lit* lit) {
-	while (head != NULL) {
-		if (head->lit == lit) {
-			return true;
+// makes a learned clause out of the given literals
+Clause* make_learned_clause(Lit** lits, c2dSize num_lits) {
+	Clause* clause = (Clause *)malloc(sizeof(Clause));
+	initialize_Clause(clause);
+	clause->learned = true;
+	clause->num_lits = num_lits;
+	clause->literals = (Lit **)malloc(num_lits*sizeof(Lit*));
+	memcpy(clause->literals, lits, num_lits*sizeof(Lit*));
+	return clause;
+}
+
+
+// one bit per level (modulo the word size), to tell quickly that a var is
+// not implied by vars of the levels of a clause
+unsigned long abstract_level(c2dSize level) {
+	return 1UL << (level & (8 * sizeof(unsigned long) - 1));
+}
+
+// true if the false literal lit of a learned clause is implied by the other
+// literals of the clause, found by following reasons back from lit
+//
+// a var of level 1 is implied by the cnf alone, so it never needs a clause literal
+// vars shown to follow from the clause are left seen, so later literals can use them;
+// when the search fails the vars it marked are unmarked again
+BOOLEAN lit_redundant(SatState* sat_state, Lit* lit, unsigned long clause_levels, c2dSize* num_to_clear) {
+	BOOLEAN* seen = sat_state->seen;
+	Lit** stack = sat_state->minimize_stack;
+	Lit** to_clear = sat_state->minimize_to_clear;
+	c2dSize stack_size = 0;
+	c2dSize clear_start = *num_to_clear;
+
+	stack[stack_size++] = lit;
+	while (stack_size > 0) {
+		c2dSize v = lit_var_index(sat_state, stack[--stack_size]);
+		Clause* reason = sat_state->reasons[v];
+		Lit** reason_lits = (reason != NULL) ? reason->literals : sat_state->binary_reasons + v;
+		c2dSize reason_size = (reason != NULL) ? reason->num_lits : 1;
+
+		for (c2dSize i = 0; i < reason_size; i++) {
+			Lit* l = reason_lits[i];
+			c2dSize u = lit_var_index(sat_state, l);
+			if (u == v || seen[u] || sat_state->levels[u] == 1)
+				continue;
+			if ((sat_state->reasons[u] != NULL || sat_state->binary_reasons[u] != NULL)
+				&& (abstract_level(sat_state->levels[u]) & clause_levels)) {
+				seen[u] = true;
+				stack[stack_size++] = l;
+				to_clear[(*num_to_clear)++] = l;
+			}
+			else {
+				// u is a decision, or of a level the clause does not mention
+				for (c2dSize j = clear_start; j < *num_to_clear; j++)
+					seen[lit_var_index(sat_state, to_clear[j])] = false;
+				*num_to_clear = clear_start;
+				return false;
+			}
 		}
-		head = head->next;
 	}
-	return false;
+	return true;
 }
 
+// removes the literals of a learned clause which are implied by its other
+// literals through their reasons (recursive self-subsumption)
+// the UIP in lits[0] is always kept; expects the other literals to be seen and
+// leaves no var seen; returns the new number of literals
+c2dSize minimize_learned_lits(SatState* sat_state, Lit** lits, c2dSize num_lits) {
+	BOOLEAN* seen = sat_state->seen;
+	Lit** to_clear = sat_state->minimize_to_clear;
+	c2dSize num_to_clear = 0;
 
-Clause* make_clause_from_lit(LitNode* head) {
-	Clause* clause = (Clause *)malloc(sizeof(Clause));
-	initialize_Clause(clause);
-	unsigned int i = 0;
-	LitNode* tmp = head;
-	while (tmp != NULL) {
-		i++;
-		tmp = tmp->next;
-	}
-	clause->num_lits = i;
-	clause->literals = (Lit **)malloc(clause->num_lits*sizeof(Lit*));
-	i = 0;
-	tmp = head;
-	while (tmp != NULL) {
-		clause->literals[i] = flip_lit(tmp->lit);
-		tmp = tmp->next;
-		i++;
+	unsigned long clause_levels = 0;
+	for (c2dSize i = 1; i < num_lits; i++) {
+		to_clear[num_to_clear++] = lits[i];
+		clause_levels |= abstract_level(lit_level(sat_state, lits[i]));
 	}
-	return clause;
-}
 
+	c2dSize kept = 1;
+	for (c2dSize i = 1; i < num_lits; i++) {
+		c2dSize v = lit_var_index(sat_state, lits[i]);
+		BOOLEAN decided = sat_state->reasons[v] == NULL && sat_state->binary_reasons[v] == NULL;
+		if (decided || !lit_redundant(sat_state, lits[i], clause_levels, &num_to_clear))
+			lits[kept++] = lits[i];
+	}
+
+	for (c2dSize j = 0; j < num_to_clear; j++)
+		seen[lit_var_index(sat_state, to_clear[j])] = false;
+
+	sat_state->learned_literal_count += num_lits;
+	sat_state->minimized_literal_count += num_lits - kept;
+	return kept;
+}
 
+// first UIP conflict analysis
+//
+// the literals of the conflict clause at its highest level (the last level) are
+// resolved away with their reasons, most recent first, until only one is left:
+// the first UIP. The learned clause is the negation of the UIP and the false
+// literals of lower levels met on the way, in the order they were met.
+// sat_state->seen marks the vars met so far, so each var is looked at once
+// and the trail is walked backwards a single time
 Clause* get_asserting_clause(SatState* sat_state) {
-	//printstuff(sat_state);
-	LitNode* q_head = NULL; // Note this has been used w/o being initilized
-	LitNode* l_head = NULL; // Note this has been used w/o being initilized
 	Clause* conflict_reason = sat_state->conflict_reason;
-	
-	unsigned long last_level = get_last_level(conflict_reason);
-	// initialize from conflict
-	for (unsigned long i = 0; i < conflict_reason->num_lits; i++) {
-
-		LitNode* node = (LitNode*)malloc(sizeof(LitNode));
-		initialize_LitNode(node);
-		node->lit = flip_lit(conflict_reason->literals[i]);
-		if (conflict_reason->literals[i]->var->level == last_level) { // last level node added to queue
-			if (!is_lit_duplicate(q_head, node->lit)) {
-				if (q_head == NULL) {
-					q_head = node;
-				}
-				else {
-					q_head = append(q_head, node);
-				}
-				LitNode* tmp = q_head;
-				while (tmp != NULL) {
-					tmp = tmp->next;
-				}
-			}
+	c2dSize last_level = get_last_level(sat_state, conflict_reason);
+	BOOLEAN* seen = sat_state->seen;
+	Lit** learned_lits = sat_state->learned_lits; // learned_lits[0] is kept for the UIP
+	c2dSize num_learned_lits = 1;
+	c2dSize pending = 0; // seen vars of the last level which are not resolved yet
+	uint32_t trail_pos = sat_state->trail_size;
+
+	bump_learned_clause(sat_state, conflict_reason);
+
+	Lit* implied = NULL; // the true literal whose reason is resolved
+	Lit** reason_lits = conflict_reason->literals;
+	c2dSize reason_size = conflict_reason->num_lits;
+	Lit* binary_reason[2];
+
+	for (;;) {
+		for (c2dSize i = 0; i < reason_size; i++) {
+			Lit* l = reason_lits[i];
+			if (l == implied)
+				continue;
+			c2dSize v = lit_var_index(sat_state, l);
+			if (seen[v])
+				continue;
+			seen[v] = true;
+			bump_var_activity(sat_state, v);
+			if (sat_state->levels[v] == last_level)
+				pending++;
+			else
+				learned_lits[num_learned_lits++] = l;
+		}
+
+		// the most recent seen var of the last level is the next one to resolve
+		c2dSize v;
+		do {
+			implied = sat_state->trail[--trail_pos];
+			v = lit_var_index(sat_state, implied);
+		} while (!seen[v] || sat_state->levels[v] != last_level);
+		seen[v] = false;
+
+		if (--pending == 0)
+			break;
+
+		// a decision cannot have pending vars of its level before it
+		assert(sat_state->reasons[v] != NULL || sat_state->binary_reasons[v] != NULL);
+		if (sat_state->reasons[v] != NULL) {
+			bump_learned_clause(sat_state, sat_state->reasons[v]);
+			reason_lits = sat_state->reasons[v]->literals;
+			reason_size = sat_state->reasons[v]->num_lits;
 		}
 		else {
-			if (!is_lit_duplicate(l_head, node->lit)) { // not last level node added to list
-				if (l_head == NULL) {
-					l_head = node;
-				}
-				else {
-					l_head = append(l_head, node);
-				}
-			}
+			// a binary reason is the implied lit and the false lit that implied it
+			binary_reason[0] = implied;
+			binary_reason[1] = sat_state->binary_reasons[v];
+			reason_lits = binary_reason;
+			reason_size = 2;
 		}
 	}
+	learned_lits[0] = flip_lit(implied);
 
-	if (q_head == NULL)
-	{
-		q_head->next = l_head;
-		Clause* c = make_clause_from_lit(q_head);
-		return c;
+	num_learned_lits = minimize_learned_lits(sat_state, learned_lits, num_learned_lits);
+
+	// the assertion level is the highest level below the last one (1 for a unit clause)
+	c2dSize assertion_level = 1;
+	for (c2dSize i = 1; i < num_learned_lits; i++) {
+		c2dSize v = lit_var_index(sat_state, learned_lits[i]);
+		if (sat_state->levels[v] > assertion_level)
+			assertion_level = sat_state->levels[v];
 	}
+	sat_state->assertion_level = assertion_level;
 
-	// Constructing queue and list
-	// If more than one literal at last level
+	decay_var_activity(sat_state);
+	sat_state->num_conflicts += 1;
 
-	while (q_head->next != NULL)
-	{
-		// Get the highest ticket number in the q_head list
-		LitNode* q_ptr = q_head;
-		LitNode* prev_of_highest_ticket_lit = NULL;
-		Lit* highest_ticket_lit = q_head->lit;
-		while (q_ptr->next != NULL)
-		{
-			if (q_ptr->next->lit->var->ticket > highest_ticket_lit->var->ticket)
-			{
-				highest_ticket_lit = q_ptr->next->lit;
-				prev_of_highest_ticket_lit = q_ptr;
-			}
-			q_ptr = q_ptr->next;
-		}
+	Clause* clause = make_learned_clause(learned_lits, num_learned_lits);
+	clause->lbd = compute_lbd(sat_state, learned_lits, num_learned_lits);
+	clause->tier = lbd_tier(clause->lbd);
+	update_lbd_averages(sat_state, clause->lbd);
+	return clause;
+}
 
-		// The decided lit at highest level has higher ticket number than implied
-		// This should not happen!
-		if (highest_ticket_lit->reason == NULL) {
-			//print_sat_state_clauses(sat_state);
-			printf("Highest ticket lit has no reason...ticket=%d, level=%d\n", highest_ticket_lit->var->ticket, highest_ticket_lit->var->level);
-			print_clause(conflict_reason);
-			printf("Called because...");
-			if (sat_state->call_stat == learn_call)
-				printf("learned\n");
-			else if (sat_state->call_stat == decide_call)
-				printf("decide\n");
-			else
-				printf("first time\n");
-			assert(false);
-		}
+// Restarts
 
-		// Otherwise it's an implied lit
-		Clause* reason = highest_ticket_lit->reason;
-		for (unsigned long i = 0; i < reason->num_lits; i++) {
-			if (highest_ticket_lit == reason->literals[i]) {
-				continue;
-			}
-			LitNode* node = (LitNode*)malloc(sizeof(LitNode));
-			initialize_LitNode(node);
-			node->lit = flip_lit(reason->literals[i]);
-			if (reason->literals[i]->var->level == last_level) { // last level node added to queue
-				if (!is_lit_duplicate(q_head, node->lit)) {
-					q_head = append(q_head, node);
-				}
-			}
-			else {
-				if (!is_lit_duplicate(l_head, node->lit)) { // not last level node added to list
-					l_head = append(l_head, node);
-				}
-			}
+// the i-th term (from 1) of the luby sequence 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+c2dSize luby(c2dSize i) {
+	// find the finite subsequence of length 2^k-1 that contains i, and then the
+	// place of i in it, which repeats the previous subsequence twice
+	c2dSize size = 1, k = 0, x = i - 1;
+	while (size < x + 1) {
+		k++;
+		size = 2 * size + 1;
+	}
+	while (size - 1 != x) {
+		size = (size - 1) >> 1;
+		k--;
+		x = x % size;
+	}
+	return (c2dSize)1 << k;
+}
+
+// moves the averages of LBD over the recent (fast) and all (slow) learned clauses
+void update_lbd_averages(SatState* sat_state, c2dSize lbd) {
+	sat_state->conflicts_since_restart += 1;
+	// the slow average starts as a plain one, until it has seen 1/ema_slow_alpha clauses
+	double slow_alpha = 1.0 / (double)sat_state->num_conflicts;
+	if (slow_alpha < ema_slow_alpha)
+		slow_alpha = ema_slow_alpha;
+	sat_state->lbd_ema_fast += ema_fast_alpha * ((double)lbd - sat_state->lbd_ema_fast);
+	sat_state->lbd_ema_slow += slow_alpha * ((double)lbd - sat_state->lbd_ema_slow);
+}
+
+// Budgets
+
+// seconds on the monotonic clock
+double monotonic_seconds() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// true if unit resolution has to stop: it was interrupted, or a budget ran out
+// the clock is costlier to read, so it is only looked at every
+// budget_check_interval propagations
+BOOLEAN budget_exhausted(SatState* sat_state) {
+	if (__atomic_load_n(&sat_state->interrupt_requested, __ATOMIC_RELAXED))
+		return true;
+	if (sat_state->conflict_limit != 0 && sat_state->num_conflicts >= sat_state->conflict_limit)
+		return true;
+	if (sat_state->propagation_limit != 0 && sat_state->num_propagations >= sat_state->propagation_limit)
+		return true;
+	if (sat_state->memory_limit != 0 && sat_state->learned_bytes >= sat_state->memory_limit)
+		return true;
+	if ((sat_state->num_propagations & (budget_check_interval - 1)) != 0)
+		return false;
+	return sat_state->deadline != 0 && monotonic_seconds() >= sat_state->deadline;
+}
+
+// Solving under assumptions
+
+// asserts learned clauses, backtracking to their assertion levels, until one is
+// asserted without a contradiction
+// returns 1 if that happens, 0 if a contradiction is found with nothing decided,
+// result_unknown if unit resolution was stopped
+BOOLEAN assert_learned_clause(Clause* learned, SatState* sat_state) {
+	while (learned != NULL) {
+		if (sat_state->stopped)
+			return result_unknown;
+		sat_backtrack_to_level(sat_assertion_level(learned, sat_state), sat_state);
+		BOOLEAN top_level = (sat_state->num_decisions == 0);
+		learned = sat_assert_clause(learned, sat_state);
+		// once stopped, the clause returned is stop_clause, which is not learned
+		if (sat_state->stopped)
+			return result_unknown;
+		if (learned != NULL && top_level) {
+			// nothing can be asserted below level 1
+			free(learned->literals);
+			free(learned);
+			return 0;
 		}
+	}
+	return 1;
+}
 
+// returns the first of the assumptions which is not true, NULL if all of them are
+// sets *refuted if that one is false
+Lit* next_assumption(SatState* sat_state, const c2dLiteral* assumptions, c2dSize num_assumptions, BOOLEAN* refuted) {
+	for (c2dSize i = 0; i < num_assumptions; i++) {
+		assert(assumptions[i] != 0 && (c2dSize)labs(assumptions[i]) <= sat_state->num_vars);
+		Lit* lit = sat_index2literal(assumptions[i], sat_state);
+		if (is_lit_true(lit))
+			continue;
+		*refuted = is_lit_false(lit);
+		return lit;
+	}
+	return NULL;
+}
 
-		// Remove the litnode after prev_of_highest_lit_node
-		if (prev_of_highest_ticket_lit != NULL)
-		{
-			LitNode* to_free = prev_of_highest_ticket_lit->next;
-			prev_of_highest_ticket_lit->next = to_free->next;
-			free(to_free);
+// makes the final conflict of the false assumption lit: lit, and the decisions
+// its negation was implied from, found by following reasons back on the trail
+// all these decisions are assumptions; a literal false at level 1 needs none
+void analyze_final(SatState* sat_state, Lit* lit) {
+	BOOLEAN* seen = sat_state->seen;
+	c2dSize* levels = sat_state->levels;
+	sat_state->final_conflict[0] = lit->index;
+	sat_state->final_conflict_size = 1;
+	c2dSize lit_v = lit_var_index(sat_state, lit);
+	if (levels[lit_v] == 1)
+		return;
+
+	// every seen var is above level 1, so it is after the first decision
+	seen[lit_v] = true;
+	for (uint32_t i = sat_state->trail_size; i-- > sat_state->level_starts[0];) {
+		Lit* l = sat_state->trail[i];
+		c2dSize v = lit_var_index(sat_state, l);
+		if (!seen[v])
+			continue;
+		seen[v] = false;
+		Clause* reason = sat_state->reasons[v];
+		if (reason == NULL && sat_state->binary_reasons[v] == NULL) {
+			sat_state->final_conflict[sat_state->final_conflict_size++] = l->index;
+			continue;
 		}
-		else
-		{
-			// Free the head
-			LitNode* to_free = q_head;
-			q_head = q_head->next;
-			free(to_free);
+		Lit** reason_lits = (reason != NULL) ? reason->literals : sat_state->binary_reasons + v;
+		c2dSize reason_size = (reason != NULL) ? reason->num_lits : 1;
+		for (c2dSize k = 0; k < reason_size; k++) {
+			c2dSize u = lit_var_index(sat_state, reason_lits[k]);
+			if (u != v && levels[u] > 1)
+				seen[u] = true;
 		}
-
 	}
+}
 
-	LitNode* tmp = l_head;
-	while (tmp != NULL) {
-		tmp = tmp->next;
+// number of distinct levels among the given literals
+c2dSize compute_lbd(SatState* sat_state, Lit** lits, c2dSize num_lits) {
+	c2dSize stamp = ++sat_state->lbd_stamp;
+	c2dSize lbd = 0;
+	for (c2dSize i = 0; i < num_lits; i++) {
+		c2dSize level = lit_level(sat_state, lits[i]);
+		if (sat_state->level_stamps[level] != stamp) {
+			sat_state->level_stamps[level] = stamp;
+			lbd++;
+		}
 	}
+	return lbd;
+}
 
-	tmp = q_head;
-	while (tmp != NULL) {
-		tmp = tmp->next;
-	}
-	q_head->next = l_head;
-	Clause* clause = make_clause_from_lit(q_head);
-//BOOKMARK
-	// Get assertion level from this clause
+tierstat lbd_tier(c2dSize lbd) {
+	if (lbd <= core_max_lbd)
+		return tier_core;
+	if (lbd <= tier2_max_lbd)
+		return tier_2;
+	return tier_local;
+}
 
-	if (clause->num_lits == 1)
-	{
-		sat_state->assertion_level = 1;
-		return clause;
+// a learned clause used by conflict analysis is kept through the next
+// reduction, and moves to a better tier if its lbd went down
+void bump_learned_clause(SatState* sat_state, Clause* c) {
+	if (!c->learned || c->tier == tier_core)
+		return;
+	c->used = true;
+	c2dSize lbd = compute_lbd(sat_state, c->literals, c->num_lits);
+	if (lbd < c->lbd) {
+		c->lbd = lbd;
+		c->tier = lbd_tier(lbd);
 	}
+}
 
-	c2dSize assertion_level = 1;
-	c2dSize highest_level = 1;
+// true if the clause implied one of the literals on the trail
+// the implied literal is always one of the watches of the clause
+BOOLEAN is_reason_clause(SatState* sat_state, Clause* c) {
+	if (c->watch1 == NULL)
+		return true; // unit and binary clauses are not looked into
+	return (is_lit_true(c->watch1) && sat_state->reasons[lit_var_index(sat_state, c->watch1)] == c)
+		|| (is_lit_true(c->watch2) && sat_state->reasons[lit_var_index(sat_state, c->watch2)] == c);
+}
 
-	// Get highest level
-	for (unsigned int i = 0; i < clause->num_lits; i++)
-	{
-		if ((clause->literals[i]->var->level)>highest_level)
-			highest_level = (clause->literals[i]->var->level);
-	}
+// highest lbd first, then longest first
+int compare_reduce_order(const void* a, const void* b) {
+	const Clause* c1 = *(const Clause**)a;
+	const Clause* c2 = *(const Clause**)b;
+	if (c1->lbd != c2->lbd)
+		return (c1->lbd < c2->lbd) ? 1 : -1;
+	if (c1->num_lits != c2->num_lits)
+		return (c1->num_lits < c2->num_lits) ? 1 : -1;
+	return 0;
+}
 
-	// Get assertion_level
-	for (unsigned int i = 0; i < clause->num_lits; i++)
-	{
-		if (((clause->literals[i]->var->level)>assertion_level)
-			&& ((clause->literals[i]->var->level) != highest_level))
-			assertion_level = (clause->literals[i]->var->level);
+// deletes the worse half of the local learned clauses which were not used since
+// the last reduction and are not reasons; unused tier2 clauses become local
+//
+// the kept learned clauses are renumbered, so sat_index2clause and
+// sat_learned_clause_count keep describing the current clause set
+// memory of a learned clause: its structure, its literals and its two watches
+c2dSize learned_clause_bytes(const Clause* c) {
+	return sizeof(Clause) + c->num_lits * sizeof(Lit*) + 2 * sizeof(Clause*);
+}
+
+void reduce_learned_clauses(SatState* sat_state) {
+	ClausePtrVector* learned = &(sat_state->learned_clauses);
+	Clause** candidates = (Clause**)malloc((learned->current + 1) * sizeof(Clause*));
+	size_t num_candidates = 0;
+
+	for (size_t i = 0; i < learned->current; i++) {
+		Clause* c = learned->clause[i];
+		if (c->tier == tier_2 && !c->used)
+			c->tier = tier_local;
+		else if (c->tier == tier_local && !c->used && !is_reason_clause(sat_state, c))
+			candidates[num_candidates++] = c;
+		c->used = false;
 	}
 
-	sat_state->assertion_level = assertion_level;
+	qsort(candidates, num_candidates, sizeof(Clause*), compare_reduce_order);
+	size_t num_deleted = num_candidates / 2;
+	for (size_t i = 0; i < num_deleted; i++)
+		candidates[i]->deleted = true;
+	free(candidates);
+	if (num_deleted == 0)
+		return;
 
-	return clause;
+	// Drop the deleted clauses from the watch lists
+	for (c2dSize i = 2; i < 2 * sat_state->num_vars + 2; i++) {
+		ClausePtrVector* watchers = &(sat_state->lits[i].watched_clauses);
+		size_t j = 0;
+		for (size_t k = 0; k < watchers->current; k++) {
+			if (!watchers->clause[k]->deleted)
+				watchers->clause[j++] = watchers->clause[k];
+		}
+		watchers->current = j;
+	}
+
+	// Free them, and renumber the kept clauses
+	size_t j = 0;
+	for (size_t i = 0; i < learned->current; i++) {
+		Clause* c = learned->clause[i];
+		if (c->deleted) {
+			proof_clause(sat_state, 'd', c->literals, c->num_lits);
+			clause_set_remove(sat_state, c);
+			sat_state->learned_bytes -= learned_clause_bytes(c);
+			free(c->literals);
+			free(c);
+			continue;
+		}
+		learned->clause[j++] = c;
+		c->index = sat_state->num_orig_clauses + j;
+	}
+	learned->current = j;
 }
 
 
-unsigned int count_free_lit(Clause* c) {
+unsigned int count_free_lit(const Clause* c) {
 	unsigned int count = 0;
 	for (unsigned i = 0; i<c->num_lits; i++) {
-		if (c->literals[i]->var->status == free_var) {
+		if (*c->literals[i]->value == 0) {
 			count++;
 		}
 	}
@@ -1497,7 +2533,7 @@ unsigned int count_free_lit(Clause* c) {
 }
 
 
-unsigned int count_subsumed_lit(Clause* c) {
+unsigned int count_subsumed_lit(const Clause* c) {
 	if (c == NULL)
 	{
 		//printf("Called count_subsumed_lit with NULL clause\n");
@@ -1506,10 +2542,7 @@ unsigned int count_subsumed_lit(Clause* c) {
 	}
 	unsigned int count = 0;
 	for (unsigned i = 0; i<c->num_lits; i++) {
-		if ((c->literals[i]->var->status == implied_pos
-			&& c->literals[i]->index>0) ||
-			(c->literals[i]->var->status == implied_neg
-			&& c->literals[i]->index<0)) {
+		if (*c->literals[i]->value > 0) {
 			count++;
 		}
 	}
@@ -1518,7 +2551,9 @@ unsigned int count_subsumed_lit(Clause* c) {
 
 void print_clause(Clause* c) {
 	for (unsigned int i = 0; i < c->num_lits; i++) {
-		printf(" %d<%d>[%d]", c->literals[i]->index, c->literals[i]->var->level, c->literals[i]->var->ticket);
+		SatState* sat_state = c->literals[i]->var->state;
+		c2dSize v = c->literals[i]->var->index;
+		printf(" %ld<%lu>", c->literals[i]->index, sat_state->levels[v]);
 		if (c->literals[i]->var->status == free_var)
 			printf("(free) ");
 		else if (c->literals[i]->var->status == implied_pos)
@@ -1531,28 +2566,15 @@ void print_clause(Clause* c) {
 
 void print_sat_state_clauses(SatState* sat_state) {
 	printf("\n\nPrinting all clauses...\n");
-	ClauseNode* cnf_ptr = sat_state->cnf_head;
-	while (cnf_ptr != NULL)
-	{
-		Clause* c = cnf_ptr->clause;
-		print_clause(c);
-		cnf_ptr = cnf_ptr->next;
-	}
-
-	printf("\n\nPrinting all decided...\n");
-	LitNode* n = sat_state->decided_literals;
-	while (n != NULL) {
-		printf(" %d<%d>[%d]", n->lit->index, n->lit->var->level, n->lit->var->ticket);
-		n = n->next;
-	}
-	printf("\n");
-
-
-	printf("\n\nPrinting all implied...\n");
-	n = sat_state->implied_literals;
-	while (n != NULL) {
-		printf(" %d<%d>[%d]", n->lit->index, n->lit->var->level, n->lit->var->ticket);
-		n = n->next;
+	c2dSize num_clauses = sat_clause_count(sat_state) + sat_learned_clause_count(sat_state);
+	for (c2dSize i = 1; i <= num_clauses; i++)
+		print_clause(sat_index2clause(i, sat_state));
+
+	printf("\n\nPrinting the trail (decisions marked with *)...\n");
+	for (uint32_t i = 0; i < sat_state->trail_size; i++) {
+		Lit* l = sat_state->trail[i];
+		c2dSize v = lit_var_index(sat_state, l);
+		printf(" %s%ld<%lu>", (sat_state->reasons[v] == NULL && sat_state->binary_reasons[v] == NULL) ? "*" : "", l->index, sat_state->levels[v]);
 	}
 	printf("\n");
 
@@ -1560,19 +2582,19 @@ void print_sat_state_clauses(SatState* sat_state) {
 
 BOOLEAN assignment_is_sat(SatState* sat_state)
 {
-	ClauseNode* cnf_ptr = sat_state->cnf_head;
-	while (cnf_ptr != NULL)
+	c2dSize num_clauses = sat_clause_count(sat_state) + sat_learned_clause_count(sat_state);
+	for (c2dSize k = 1; k <= num_clauses; k++)
 	{
-		Lit** l = cnf_ptr->clause->literals;
+		Clause* c = sat_index2clause(k, sat_state);
+		Lit** l = c->literals;
 		BOOLEAN clause_subsumed = false;
-		for (unsigned int i = 0; i < cnf_ptr->clause->num_lits; i++)
+		for (unsigned int i = 0; i < c->num_lits; i++)
 		{
-			if (l[i]->var->status == free_var)
+			if (*l[i]->value == 0)
 			{
 				return false;
 			}
-			if ((l[i]->var->status == implied_neg && l[i]->index < 0)
-				|| (l[i]->var->status == implied_pos && l[i]->index > 0))
+			if (*l[i]->value > 0)
 			{
 				clause_subsumed = true;
 				break;
@@ -1580,12 +2602,45 @@ BOOLEAN assignment_is_sat(SatState* sat_state)
 		}
 		if (!clause_subsumed)
 			return false;
-		cnf_ptr = cnf_ptr->next;
 	}
 	return true;
 }
 
 
+// flushes the proof buffer unless it has room for num_bytes more
+void proof_reserve(SatState* sat_state, size_t num_bytes) {
+	if (sat_state->proof_size + num_bytes <= sat_state->proof_capacity)
+		return;
+	sat_state->proof_buffer = sat_state->proof_flush(sat_state->proof_sink, sat_state->proof_buffer, sat_state->proof_size);
+	sat_state->proof_size = 0;
+}
+
+// writes a line of the binary DRAT proof, if one is written: kind ('a' for an added
+// clause, 'd' for a deleted one), the literals and a 0
+// each literal is its code in 7 bit groups, low ones first, the high bit of a byte
+// telling that more follow; the DRAT code of a literal is 2v if it is the positive
+// literal of var v and 2v+1 if the negative one, which is its place in the literal block
+void proof_clause(SatState* sat_state, unsigned char kind, Lit** lits, c2dSize num_lits) {
+	if (sat_state->proof_flush == NULL)
+		return;
+	proof_reserve(sat_state, 1);
+	sat_state->proof_buffer[sat_state->proof_size++] = kind;
+	for (c2dSize i = 0; i < num_lits; i++) {
+		proof_reserve(sat_state, proof_lit_bytes);
+		unsigned char* out = sat_state->proof_buffer + sat_state->proof_size;
+		c2dSize code = (c2dSize)(lits[i] - sat_state->lits);
+		while (code > 127) {
+			*out++ = (unsigned char)(code | 128);
+			code >>= 7;
+		}
+		*out++ = (unsigned char)code;
+		sat_state->proof_size = out - sat_state->proof_buffer;
+	}
+	proof_reserve(sat_state, 1);
+	sat_state->proof_buffer[sat_state->proof_size++] = 0;
+}
+
+
 /******************************************************************************
 * end
 ******************************************************************************/
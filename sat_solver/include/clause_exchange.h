@@ -0,0 +1,48 @@
+#ifndef CLAUSE_EXCHANGE_H_
+#define CLAUSE_EXCHANGE_H_
+
+#include <stdint.h>
+#include "sat_api.h"
+
+/******************************************************************************
+ * Clause exchange between sat states solving the same cnf on different threads
+ *
+ * A bounded ring of clauses every thread writes to and reads from, without locks.
+ * Each clause written takes the next ticket, and goes to slot ticket%capacity,
+ * overwriting the clause written capacity tickets earlier. Each reader keeps the
+ * ticket it reads next, and skips the clauses it has been lapped on.
+ *
+ * A slot is guarded by a sequence number: 2t+1 while the clause of ticket t is
+ * written into it, 2t+2 once it is there. Readers copy the clause out, and keep
+ * it only if the sequence number was 2t+2 before and after copying. Clauses
+ * can get lost (overwritten, or raced with), which only costs the sharing.
+ ******************************************************************************/
+
+#define EXCHANGE_CAPACITY 4096 //power of 2
+#define EXCHANGE_MAX_LITS 32   //longer clauses are not shared
+
+typedef struct {
+  uint64_t sequence;
+  int producer;
+  c2dSize lbd;
+  c2dSize num_lits;
+  c2dLiteral lits[EXCHANGE_MAX_LITS];
+} ExchangeSlot;
+
+typedef struct {
+  ExchangeSlot* slots;
+  uint64_t tickets; //taken so far
+} ClauseExchange;
+
+ClauseExchange* exchange_new();
+void exchange_free(ClauseExchange* exchange);
+
+//writes a clause learned by thread producer
+void exchange_export(ClauseExchange* exchange, int producer, const Clause* clause);
+
+//imports into sat state the clauses written by the other threads since ticket
+//*cursor, and moves *cursor past them
+//returns 0 if importing them shows that the cnf is unsatisfiable, 1 otherwise
+BOOLEAN exchange_import(ClauseExchange* exchange, int consumer, uint64_t* cursor, SatState* sat_state);
+
+#endif //CLAUSE_EXCHANGE_H_
@@ -0,0 +1,42 @@
+#ifndef PROOF_WRITER_H_
+#define PROOF_WRITER_H_
+
+#include <pthread.h>
+#include "sat_api.h"
+
+/******************************************************************************
+ * Proof writer: the proof of a sat state written to a file by its own thread
+ *
+ * The sat state fills one buffer of a ring while the writer thread writes the
+ * full ones out, in order. Handing over a full buffer takes a lock and no copy;
+ * the sat state only waits when every other buffer is still being written.
+ ******************************************************************************/
+
+#define PROOF_BUFFERS 4
+#define PROOF_BUFFER_BYTES (1<<20)
+
+typedef struct {
+  FILE* file;
+  unsigned char* buffers[PROOF_BUFFERS];
+  size_t sizes[PROOF_BUFFERS];
+  int head;     //buffers[head..head+num_full) (mod PROOF_BUFFERS) are full, oldest first
+  int num_full; //the one after them is being filled
+  BOOLEAN closing;
+  BOOLEAN failed; //a write failed
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  pthread_t thread;
+} ProofWriter;
+
+//returns a writer to the file fname, with its thread started, NULL if the file
+//cannot be opened
+ProofWriter* proof_writer_new(const char* fname);
+
+//makes sat state write its proof through writer
+void proof_writer_attach(ProofWriter* writer, SatState* sat_state);
+
+//writes out the full buffers, stops the thread and frees writer
+//returns 0 if the proof could not all be written, 1 otherwise
+BOOLEAN proof_writer_close(ProofWriter* writer);
+
+#endif //PROOF_WRITER_H_
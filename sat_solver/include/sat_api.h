@@ -15,6 +15,7 @@ typedef char BOOLEAN; //signed
 typedef unsigned long c2dSize;  //for variables, clauses, and various things
 typedef signed long c2dLiteral; //for literals
 typedef double c2dWmc;          //for (weighted) model count
+typedef unsigned char* (*ProofFlush)(void* sink, unsigned char* bytes, size_t num_bytes);
 
 typedef struct var Var;
 typedef struct literal Lit;
@@ -50,9 +51,14 @@ c2dLiteral sat_literal_index(const Lit* lit);
 Lit* sat_pos_literal(const Var* var);
 Lit* sat_neg_literal(const Var* var);
 BOOLEAN sat_implied_literal(const Lit* lit);
+Lit* sat_pick_branch_literal(SatState* sat_state);
+BOOLEAN sat_set_phase_mode(SatState* sat_state, const char* mode);
+void sat_set_seed(SatState* sat_state, c2dSize seed);
+Lit* sat_lookahead_literal(SatState* sat_state, c2dSize num_candidates, BOOLEAN* forced);
 c2dWmc sat_literal_weight(const Lit* lit);
 Clause* sat_decide_literal(Lit* lit, SatState* sat_state);
 void sat_undo_decide_literal(SatState* sat_state);
+void sat_backtrack_to_level(c2dSize level, SatState* sat_state);
 
 /******************************************************************************
  * Clauses 
@@ -62,10 +68,15 @@ Clause* sat_index2clause(c2dSize index, const SatState* sat_state);
 c2dSize sat_clause_index(const Clause* clause);
 Lit** sat_clause_literals(const Clause* clause);
 c2dSize sat_clause_size(const Clause* clause);
+c2dSize sat_clause_lbd(const Clause* clause);
 BOOLEAN sat_subsumed_clause(const Clause* clause);
+c2dSize sat_falsified_clause(const SatState* sat_state, const c2dLiteral* model, c2dSize first, c2dSize last);
 c2dSize sat_clause_count(const SatState* sat_state);
 c2dSize sat_learned_clause_count(const SatState* sat_state);
+c2dSize sat_learned_literal_count(const SatState* sat_state);
+c2dSize sat_minimized_literal_count(const SatState* sat_state);
 Clause* sat_assert_clause(Clause* clause, SatState* sat_state);
+BOOLEAN sat_import_clause(const c2dLiteral* lits, c2dSize num_lits, c2dSize lbd, SatState* sat_state);
 BOOLEAN sat_marked_clause(const Clause* clause);
 void sat_mark_clause(Clause* clause);
 void sat_unmark_clause(Clause* clause);
@@ -74,11 +85,24 @@ void sat_unmark_clause(Clause* clause);
  * SatState
  ******************************************************************************/
 
-SatState* sat_state_new(const char* file_name);
+SatState* sat_state_new(const char* file_name); //NULL if the file cannot be read, or is not a cnf
+SatState* sat_state_clone(const SatState* sat_state);
 void sat_state_free(SatState* sat_state);
 BOOLEAN sat_unit_resolution(SatState* sat_state);
 void sat_undo_unit_resolution(SatState* sat_state);
 BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state);
+c2dSize sat_decision_level(const SatState* sat_state);
+c2dSize sat_assertion_level(const Clause* clause, const SatState* sat_state);
+BOOLEAN sat_set_restart_mode(SatState* sat_state, const char* mode);
+BOOLEAN sat_restart_due(SatState* sat_state);
+c2dSize sat_restart_count(const SatState* sat_state);
+void sat_set_budget(SatState* sat_state, c2dSize conflicts, c2dSize propagations, double seconds, c2dSize megabytes);
+void sat_interrupt(SatState* sat_state);
+BOOLEAN sat_stopped(const SatState* sat_state);
+BOOLEAN sat_solve_assumptions(SatState* sat_state, const c2dLiteral* assumptions, c2dSize num_assumptions);
+const c2dLiteral* sat_final_conflict(const SatState* sat_state, c2dSize* size);
+void sat_set_proof(SatState* sat_state, ProofFlush flush, void* sink, unsigned char* buffer, size_t capacity);
+void sat_end_proof(SatState* sat_state, BOOLEAN unsatisfiable);
 
 #endif //SATAPI_H_
 
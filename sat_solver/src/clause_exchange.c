@@ -0,0 +1,68 @@
+#include "clause_exchange.h"
+
+/******************************************************************************
+ * Clause exchange (see clause_exchange.h)
+ *
+ * The clause fields of a slot can be written while another thread reads them,
+ * so they are accessed with relaxed atomics; the sequence number orders them.
+ ******************************************************************************/
+
+ClauseExchange* exchange_new() {
+  ClauseExchange* exchange = (ClauseExchange*)malloc(sizeof(ClauseExchange));
+  exchange->slots = (ExchangeSlot*)calloc(EXCHANGE_CAPACITY,sizeof(ExchangeSlot));
+  exchange->tickets = 0;
+  return exchange;
+}
+
+void exchange_free(ClauseExchange* exchange) {
+  free(exchange->slots);
+  free(exchange);
+}
+
+void exchange_export(ClauseExchange* exchange, int producer, const Clause* clause) {
+  c2dSize num_lits = sat_clause_size(clause);
+  if(num_lits>EXCHANGE_MAX_LITS) return;
+
+  uint64_t ticket = __atomic_fetch_add(&exchange->tickets,1,__ATOMIC_RELAXED);
+  ExchangeSlot* slot = exchange->slots+(ticket&(EXCHANGE_CAPACITY-1));
+
+  //claim the slot, unless it is being written or a later ticket got it first
+  uint64_t sequence = __atomic_load_n(&slot->sequence,__ATOMIC_RELAXED);
+  do {
+    if((sequence&1) || sequence>2*ticket) return;
+  } while(!__atomic_compare_exchange_n(&slot->sequence,&sequence,2*ticket+1,0,__ATOMIC_ACQUIRE,__ATOMIC_RELAXED));
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  Lit** lits = sat_clause_literals(clause);
+  __atomic_store_n(&slot->producer,producer,__ATOMIC_RELAXED);
+  __atomic_store_n(&slot->lbd,sat_clause_lbd(clause),__ATOMIC_RELAXED);
+  __atomic_store_n(&slot->num_lits,num_lits,__ATOMIC_RELAXED);
+  for(c2dSize i=0; i<num_lits; i++) __atomic_store_n(slot->lits+i,sat_literal_index(lits[i]),__ATOMIC_RELAXED);
+
+  __atomic_store_n(&slot->sequence,2*ticket+2,__ATOMIC_RELEASE);
+}
+
+BOOLEAN exchange_import(ClauseExchange* exchange, int consumer, uint64_t* cursor, SatState* sat_state) {
+  c2dLiteral lits[EXCHANGE_MAX_LITS];
+  uint64_t tickets = __atomic_load_n(&exchange->tickets,__ATOMIC_ACQUIRE);
+  if(tickets-*cursor>EXCHANGE_CAPACITY) *cursor = tickets-EXCHANGE_CAPACITY; //lapped
+
+  for(; *cursor<tickets; (*cursor)++) {
+    uint64_t ticket = *cursor;
+    ExchangeSlot* slot = exchange->slots+(ticket&(EXCHANGE_CAPACITY-1));
+    if(__atomic_load_n(&slot->sequence,__ATOMIC_ACQUIRE)!=2*ticket+2) continue; //not there (yet)
+
+    int producer = __atomic_load_n(&slot->producer,__ATOMIC_RELAXED);
+    c2dSize lbd = __atomic_load_n(&slot->lbd,__ATOMIC_RELAXED);
+    c2dSize num_lits = __atomic_load_n(&slot->num_lits,__ATOMIC_RELAXED);
+    if(num_lits>EXCHANGE_MAX_LITS) continue;
+    for(c2dSize i=0; i<num_lits; i++) lits[i] = __atomic_load_n(slot->lits+i,__ATOMIC_RELAXED);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if(__atomic_load_n(&slot->sequence,__ATOMIC_RELAXED)!=2*ticket+2) continue; //overwritten meanwhile
+    if(producer==consumer) continue;
+
+    if(!sat_import_clause(lits,num_lits,lbd,sat_state)) return 0;
+  }
+  return 1;
+}
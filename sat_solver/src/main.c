@@ -1,68 +1,866 @@
+#define _POSIX_C_SOURCE 200809L //clock_gettime
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "sat_api.h"
+#include "clause_exchange.h"
+#include "proof_writer.h"
+
+#define UNKNOWN -1 //the search was stopped before finding an answer (result_unknown)
+#define REFUTED -2 //the cube of the search is unsatisfiable (the cnf may not be)
+
+//models of cnfs with more clauses than this are checked by several threads,
+//each with at least this many clauses
+#define CHECK_CLAUSES_PER_THREAD (1<<18)
+
+//number of vars the lookahead of cube-and-conquer tries at each split
+#define LOOKAHEAD_CANDIDATES 32
+
+//learned clauses of at most 2 literals, or of LBD at most SHARED_MAX_LBD, are
+//shared with the other threads of a portfolio
+#define SHARED_MAX_LBD 2
+
+//limits of each search, 0 for none (see sat_set_budget)
+typedef struct {
+  c2dSize conflicts;
+  c2dSize propagations;
+  double seconds;
+  c2dSize megabytes;
+} Budget;
+
+//a cube of cube-and-conquer: literals decided before anything else
+typedef struct {
+  c2dLiteral* lits;
+  c2dSize size;
+  BOOLEAN result; //1, REFUTED, 0 (the cnf is unsatisfiable) or UNKNOWN if not solved
+  int thread;     //which solved it
+  double seconds; //it took
+} Cube;
+
+//the cubes, and the queue of cubes of each thread, cubes[begin..end)
+//a thread takes its next cube from the end of its own queue, and when that is
+//empty steals one from the beginning of the queue of another
+typedef struct {
+  pthread_mutex_t lock;
+  int* cubes;
+  int begin;
+  int end;
+} CubeQueue;
+
+typedef struct {
+  Cube* cubes;
+  int num_cubes;
+  int cubes_limit;
+  CubeQueue* queues;
+  int num_queues;
+} CubePool;
+
+//a cnf file of a batch
+typedef struct {
+  char* fname;
+  off_t size; //bytes
+} Instance;
+
+//the cnf files of a batch, by decreasing size, solved each by one thread with
+//the same configuration and budget
+//threads take the next file in turn, and print its result as soon as they have it
+typedef struct {
+  Instance* instances;
+  int num_instances;
+  int instances_limit;
+  int next; //the next instance to solve, taken atomically
+  const char* phase_mode;
+  const char* restart_mode;
+  Budget budget;
+  BOOLEAN check_models;
+  pthread_mutex_t print_lock;
+  int num_results[3]; //UNSAT, SAT and UNKNOWN results so far
+} BatchPool;
+
+//a sat state solved by a thread, alone, as part of a portfolio, on cubes, or
+//on the instances of a batch
+typedef struct {
+  int id;
+  SatState* sat_state;
+  const char* phase_mode;
+  const char* restart_mode;
+  int* stop;   //set once a thread has an answer, shared by all threads (NULL if alone)
+  int* winner; //id of that thread, -1 before
+  ClauseExchange* exchange; //shared by all threads (NULL if alone)
+  uint64_t cursor;          //next ticket of exchange to import
+  CubePool* pool;           //cubes to solve (NULL if none)
+  BatchPool* batch;         //instances to solve (NULL if none)
+  const c2dLiteral* cube;   //being solved, cube_size literals
+  c2dSize cube_size;
+  BOOLEAN result;
+  c2dLiteral* model;        //found when result is 1 (NULL before)
+  int signal_busy;          //set while the SIGINT handler interrupts sat_state
+} Worker;
 
 /******************************************************************************
  * SAT solver 
  ******************************************************************************/
 
-//returns a literal which is free in the current setting of sat state  
-//a NAIVE implementation no one would use in practice
-//you are free to modify this (no need though)
-Lit* get_free_literal(SatState* sat_state) {
-  c2dSize var_count = sat_var_count(sat_state);
-  for(c2dSize i=0; i<var_count; i++) { //go over variables
-    Var* var  = sat_index2var(i+1,sat_state); //note index is i+1, not i
-    Lit* plit = sat_pos_literal(var);
-    Lit* nlit = sat_neg_literal(var);
-    if(!sat_implied_literal(plit) && !sat_implied_literal(nlit)) return plit;
-  }
-  return NULL; //all literals are implied
-}
-
-//if sat state is shown to be satisfiable, it returns NULL
-//otherwise, a clause must be learned and it is returned
-Clause* sat_aux(SatState* sat_state) {
-  Lit* lit = get_free_literal(sat_state);
-  if(lit==NULL) return NULL; //all literals are implied
-
-  Clause* learned = sat_decide_literal(lit,sat_state);
-  if(learned==NULL) learned = sat_aux(sat_state);
-  sat_undo_decide_literal(sat_state);
-
-  if(learned!=NULL) { //there is a conflict
-    if(sat_at_assertion_level(learned,sat_state)) {
-      learned = sat_assert_clause(learned,sat_state);
-      if(learned==NULL) return sat_aux(sat_state); //try again
-      else return learned; //new clause learned, backtrack
+//asserts learned clauses, backtracking to their assertion levels, until one is
+//asserted without a contradiction; the short or low LBD ones are shared
+//returns 1 if that happens, 0 if a contradiction is found with no decisions left,
+//UNKNOWN if unit resolution was stopped by a budget or an interruption
+BOOLEAN assert_learned(Clause* learned, Worker* worker) {
+  SatState* sat_state = worker->sat_state;
+  while(learned!=NULL) {
+    if(sat_stopped(sat_state)) return UNKNOWN;
+    if(worker->exchange!=NULL && (sat_clause_size(learned)<=2 || sat_clause_lbd(learned)<=SHARED_MAX_LBD))
+      exchange_export(worker->exchange,worker->id,learned);
+    sat_backtrack_to_level(sat_assertion_level(learned,sat_state),sat_state);
+    BOOLEAN top_level = (sat_decision_level(sat_state)==1);
+    learned = sat_assert_clause(learned,sat_state);
+    if(sat_stopped(sat_state)) return UNKNOWN; //learned is the stop clause
+    if(learned!=NULL && top_level) return 0; //contradiction without decisions
+  }
+  return 1;
+}
+
+//returns the first literal of the cube of worker which is free, NULL if none is
+//sets *refuted if one of them is false
+//
+//the literals of the cube are decided before any other, so the ones that are
+//implied are implied by the cube before them: a false one refutes the cube
+Lit* next_cube_literal(Worker* worker, BOOLEAN* refuted) {
+  for(c2dSize i=0; i<worker->cube_size; i++) {
+    Lit* lit = sat_index2literal(worker->cube[i],worker->sat_state);
+    if(sat_implied_literal(lit)) continue;
+    if(sat_implied_literal(sat_index2literal(-worker->cube[i],worker->sat_state))) *refuted = 1;
+    else return lit;
+  }
+  return NULL;
+}
+
+//decides literals until all are implied (satisfiable) or a learned clause fails
+//at the top level (unsatisfiable), restarting when the restart policy says so
+//the literals of the cube of worker are decided first; returns REFUTED if they
+//cannot all be true
+//returns UNKNOWN as soon as the stop flag of worker is set, or unit resolution
+//is stopped (see sat_stopped)
+//the clauses shared by other workers are imported whenever nothing is decided
+BOOLEAN sat_search(Worker* worker) {
+  SatState* sat_state = worker->sat_state;
+  for(;;) {
+    if(worker->stop!=NULL && __atomic_load_n(worker->stop,__ATOMIC_RELAXED)) return UNKNOWN;
+    if(worker->exchange!=NULL && sat_decision_level(sat_state)==1
+       && !exchange_import(worker->exchange,worker->id,&worker->cursor,sat_state)) return 0;
+    BOOLEAN refuted = 0;
+    Lit* lit = next_cube_literal(worker,&refuted);
+    if(refuted) return REFUTED;
+    if(lit==NULL) lit = sat_pick_branch_literal(sat_state); //free literal with the highest activity
+    if(lit==NULL) return 1; //all literals are implied
+
+    Clause* learned = sat_decide_literal(lit,sat_state);
+    if(learned!=NULL) { //there is a conflict
+      BOOLEAN asserted = assert_learned(learned,worker);
+      if(asserted!=1) return asserted;
+      if(sat_restart_due(sat_state)) sat_backtrack_to_level(1,sat_state);
     }
-    else return learned; //backtrack (still conflict)
   }
-  return NULL; //satisfiable
 }
 
-BOOLEAN sat(SatState* sat_state) {
+//keeps the assignment of the sat state of worker, in which all vars are implied,
+//as its model
+void save_model(Worker* worker) {
+  SatState* sat_state = worker->sat_state;
+  c2dSize num_vars = sat_var_count(sat_state);
+  worker->model = (c2dLiteral*)realloc(worker->model,(num_vars+1)*sizeof(c2dLiteral));
+  worker->model[0] = 0;
+  for(c2dSize v=1; v<=num_vars; v++) {
+    Lit* lit = sat_pos_literal(sat_index2var(v,sat_state));
+    worker->model[v] = (sat_implied_literal(lit)? (c2dLiteral)v: -(c2dLiteral)v);
+  }
+}
+
+BOOLEAN sat(Worker* worker) {
+  SatState* sat_state = worker->sat_state;
   BOOLEAN ret = 0;
-  if(sat_unit_resolution(sat_state)) ret = (sat_aux(sat_state)==NULL? 1: 0);
+  if(sat_unit_resolution(sat_state)) ret = sat_search(worker);
+  else if(sat_stopped(sat_state)) ret = UNKNOWN;
+  if(ret==1) save_model(worker);
+  sat_backtrack_to_level(1,sat_state);
   sat_undo_unit_resolution(sat_state); // everything goes back to the initial state
   return ret;
 }
 
+/******************************************************************************
+ * Portfolio: the same cnf solved by differently configured threads
+ ******************************************************************************/
+
+//configurations of the threads after the first, by thread number
+static const char* portfolio_restarts[] = {"glucose","luby"};
+static const char* portfolio_phases[] = {"saved","best","original","inverted"};
+
+//makes worker the winner with result, and stops the others, unless another won first
+void announce_result(Worker* worker, BOOLEAN result) {
+  int none = -1;
+  worker->result = result;
+  if(__atomic_compare_exchange_n(worker->winner,&none,worker->id,0,__ATOMIC_ACQ_REL,__ATOMIC_ACQUIRE))
+    __atomic_store_n(worker->stop,1,__ATOMIC_RELEASE);
+}
+
+//runs run on every worker, each on its own thread, with a shared stop flag
+//and clause exchange
+//returns the id of the worker which announced a result first, -1 if none did
+//(as when all were stopped)
+int run_workers(Worker* workers, int num_threads, void* (*run)(void*)) {
+  pthread_t* threads = (pthread_t*)malloc(num_threads*sizeof(pthread_t));
+  ClauseExchange* exchange = exchange_new();
+  int stop = 0;
+  int winner = -1;
+  for(int i=0; i<num_threads; i++) {
+    workers[i].stop = &stop;
+    workers[i].winner = &winner;
+    workers[i].exchange = exchange;
+    pthread_create(threads+i,NULL,run,workers+i);
+  }
+  for(int i=0; i<num_threads; i++) pthread_join(threads[i],NULL);
+  exchange_free(exchange);
+  free(threads);
+  return winner;
+}
+
+void* portfolio_worker(void* arg) {
+  Worker* worker = (Worker*)arg;
+  BOOLEAN result = sat(worker);
+  if(result!=UNKNOWN) announce_result(worker,result);
+  return NULL;
+}
+
+//solves the sat state of every worker on its own thread, until one of them has an answer
+//the workers share their short learned clauses
+//returns the id of that worker
+int portfolio(Worker* workers, int num_threads) {
+  return run_workers(workers,num_threads,portfolio_worker);
+}
+
+/******************************************************************************
+ * Cube-and-conquer: the cnf split into cubes by lookahead, which are solved
+ * by a pool of threads
+ ******************************************************************************/
+
+double seconds_now() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC,&now);
+  return now.tv_sec+now.tv_nsec*1e-9;
+}
+
+void add_cube(CubePool* pool, const c2dLiteral* lits, c2dSize size) {
+  if(pool->num_cubes==pool->cubes_limit) {
+    pool->cubes_limit = 2*pool->cubes_limit+1;
+    pool->cubes = (Cube*)realloc(pool->cubes,pool->cubes_limit*sizeof(Cube));
+  }
+  Cube* cube = pool->cubes+pool->num_cubes++;
+  cube->lits = (c2dLiteral*)malloc((size+1)*sizeof(c2dLiteral));
+  memcpy(cube->lits,lits,size*sizeof(c2dLiteral));
+  cube->size = size;
+  cube->result = UNKNOWN;
+  cube->thread = -1;
+  cube->seconds = 0;
+}
+
+//adds the cubes extending the size decisions of sat state (prefix) by depth more
+//splits, each on the literal chosen by lookahead
+//a literal implied by the decisions is added to the cube without splitting, and
+//decisions found contradictory by lookahead make no cube
+void split_cubes(SatState* sat_state, c2dLiteral* prefix, c2dSize size, int depth, CubePool* pool) {
+  BOOLEAN forced = 0;
+  Lit* lit = (depth>0? sat_lookahead_literal(sat_state,LOOKAHEAD_CANDIDATES,&forced): NULL);
+  if(lit==NULL) {
+    if(!forced) add_cube(pool,prefix,size);
+    return;
+  }
+  c2dLiteral branches[2] = {sat_literal_index(lit),-sat_literal_index(lit)};
+  for(int b=0; b<(forced? 1: 2); b++) {
+    //lookahead decided both literals already, so neither is contradictory
+    if(sat_decide_literal(sat_index2literal(branches[b],sat_state),sat_state)==NULL) {
+      prefix[size] = branches[b];
+      split_cubes(sat_state,prefix,size+1,(forced? depth: depth-1),pool);
+    }
+    sat_undo_decide_literal(sat_state);
+  }
+}
+
+//returns the cube a thread solves next, -1 if there are none left
+int take_cube(CubePool* pool, int thread) {
+  for(int k=0; k<pool->num_queues; k++) {
+    CubeQueue* queue = pool->queues+(thread+k)%pool->num_queues;
+    int cube = -1;
+    pthread_mutex_lock(&queue->lock);
+    if(queue->begin<queue->end) cube = (k==0? queue->cubes[--queue->end]: queue->cubes[queue->begin++]);
+    pthread_mutex_unlock(&queue->lock);
+    if(cube>=0) return cube;
+  }
+  return -1;
+}
+
+//solves cubes until there are none left, or one is satisfiable, or the cnf is
+//found unsatisfiable; the sat state keeps what it learned from one cube to the next
+void* cube_worker(void* arg) {
+  Worker* worker = (Worker*)arg;
+  SatState* sat_state = worker->sat_state;
+  if(!sat_unit_resolution(sat_state)) {
+    if(!sat_stopped(sat_state)) announce_result(worker,0);
+  }
+  else {
+    int c;
+    while((c = take_cube(worker->pool,worker->id))>=0) {
+      Cube* cube = worker->pool->cubes+c;
+      worker->cube = cube->lits;
+      worker->cube_size = cube->size;
+      double start = seconds_now();
+      cube->result = sat_search(worker);
+      cube->seconds = seconds_now()-start;
+      cube->thread = worker->id;
+      if(cube->result==1) save_model(worker);
+      sat_backtrack_to_level(1,sat_state);
+      if(cube->result==UNKNOWN) break; //stopped
+      if(cube->result!=REFUTED) {
+        announce_result(worker,cube->result);
+        break;
+      }
+    }
+    worker->cube_size = 0;
+  }
+  sat_backtrack_to_level(1,sat_state);
+  sat_undo_unit_resolution(sat_state); // everything goes back to the initial state
+  return NULL;
+}
+
+//splits the cnf of the first worker by depth lookahead splits, and solves the
+//cubes on the threads of the workers, reporting the time of each cube
+//returns the id of the worker which found the cnf satisfiable or unsatisfiable,
+//-1 if all cubes were refuted (the cnf is unsatisfiable), -2 if splitting or
+//some cube was stopped before an answer was found
+int cube_and_conquer(Worker* workers, int num_threads, int depth) {
+  SatState* sat_state = workers[0].sat_state;
+  CubePool pool = {NULL,0,0,NULL,num_threads};
+
+  double start = seconds_now();
+  if(sat_unit_resolution(sat_state)) {
+    c2dLiteral* prefix = (c2dLiteral*)malloc((sat_var_count(sat_state)+1)*sizeof(c2dLiteral));
+    split_cubes(sat_state,prefix,0,depth,&pool);
+    free(prefix);
+  }
+  sat_undo_unit_resolution(sat_state);
+  printf("c %d cubes, split in %.3fs\n",pool.num_cubes,seconds_now()-start);
+  if(sat_stopped(sat_state)) { //the cubes may not cover the cnf
+    for(int c=0; c<pool.num_cubes; c++) free(pool.cubes[c].lits);
+    free(pool.cubes);
+    return -2;
+  }
+
+  //the cubes are dealt to the queues in turn
+  pool.queues = (CubeQueue*)malloc(num_threads*sizeof(CubeQueue));
+  for(int i=0; i<num_threads; i++) {
+    CubeQueue* queue = pool.queues+i;
+    pthread_mutex_init(&queue->lock,NULL);
+    queue->cubes = (int*)malloc((pool.num_cubes/num_threads+1)*sizeof(int));
+    queue->begin = queue->end = 0;
+    for(int c=i; c<pool.num_cubes; c+=num_threads) queue->cubes[queue->end++] = c;
+    workers[i].pool = &pool;
+  }
+
+  int winner = run_workers(workers,num_threads,cube_worker);
+
+  for(int c=0; c<pool.num_cubes; c++) {
+    Cube* cube = pool.cubes+c;
+    if(winner<0 && cube->result==UNKNOWN) winner = -2;
+    const char* result = (cube->result==1? "SAT": cube->result==0? "UNSAT (cnf)": cube->result==REFUTED? "UNSAT": "not solved");
+    if(cube->thread<0) printf("c cube %d (%lu literals): %s\n",c,cube->size,result);
+    else printf("c cube %d (%lu literals): %s in %.3fs by thread %d\n",c,cube->size,result,cube->seconds,cube->thread);
+    free(cube->lits);
+  }
+  for(int i=0; i<num_threads; i++) {
+    pthread_mutex_destroy(&pool.queues[i].lock);
+    free(pool.queues[i].cubes);
+  }
+  free(pool.queues);
+  free(pool.cubes);
+  return winner;
+}
+
+/******************************************************************************
+ * Models: checked against every clause of the cnf, and printed
+ ******************************************************************************/
+
+//a range of the clauses of a cnf, checked against a model by a thread
+typedef struct {
+  const SatState* sat_state;
+  const c2dLiteral* model;
+  c2dSize first;
+  c2dSize last;
+  c2dSize falsified; //the first clause of the range the model falsifies, 0 if none
+} ModelCheck;
+
+void* check_model_range(void* arg) {
+  ModelCheck* check = (ModelCheck*)arg;
+  check->falsified = sat_falsified_clause(check->sat_state,check->model,check->first,check->last);
+  return NULL;
+}
+
+//returns the index of a clause of the cnf of sat state which model falsifies, 0
+//if there is none
+//the clauses are split in ranges of CHECK_CLAUSES_PER_THREAD clauses at least,
+//checked each by its own thread, up to one per processor
+c2dSize check_model(const SatState* sat_state, const c2dLiteral* model) {
+  c2dSize num_clauses = sat_clause_count(sat_state);
+  long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if(num_threads>(long)(num_clauses/CHECK_CLAUSES_PER_THREAD)) num_threads = num_clauses/CHECK_CLAUSES_PER_THREAD;
+  if(num_threads<=1) return sat_falsified_clause(sat_state,model,1,num_clauses);
+
+  ModelCheck* checks = (ModelCheck*)malloc(num_threads*sizeof(ModelCheck));
+  pthread_t* threads = (pthread_t*)malloc(num_threads*sizeof(pthread_t));
+  for(long i=0; i<num_threads; i++) {
+    checks[i].sat_state = sat_state;
+    checks[i].model = model;
+    checks[i].first = num_clauses*i/num_threads+1;
+    checks[i].last = num_clauses*(i+1)/num_threads;
+    pthread_create(threads+i,NULL,check_model_range,checks+i);
+  }
+  c2dSize falsified = 0;
+  for(long i=0; i<num_threads; i++) {
+    pthread_join(threads[i],NULL);
+    if(falsified==0) falsified = checks[i].falsified;
+  }
+  free(threads);
+  free(checks);
+  return falsified;
+}
+
+//prints model as DIMACS v lines, of about 80 characters each
+void print_model(const c2dLiteral* model, c2dSize num_vars) {
+  char line[96];
+  int length = 0;
+  for(c2dSize v=1; v<=num_vars+1; v++) {
+    char lit[24];
+    int lit_length = sprintf(lit," %ld",(v<=num_vars? model[v]: 0)); //the last literal is 0
+    if(length+lit_length>78) {
+      printf("v%s\n",line);
+      length = 0;
+    }
+    strcpy(line+length,lit);
+    length += lit_length;
+  }
+  printf("v%s\n",line);
+}
+
+/******************************************************************************
+ * Assumptions: the same cnf solved under one set of assumptions after another
+ ******************************************************************************/
+
+//set by the SIGINT handler
+static volatile sig_atomic_t interrupted = 0;
+
+//the states of the searches in progress, stopped by SIGINT
+static Worker* signal_workers = NULL;
+static int signal_num_workers = 0;
+
+//asks every search to stop; each then reports UNKNOWN
+//a batch worker frees its sat state once it is no longer set, and not before
+//the handler is done with it (see signal_busy)
+void interrupt_workers(int signal) {
+  interrupted = 1;
+  for(int i=0; i<signal_num_workers; i++) {
+    Worker* worker = signal_workers+i;
+    __atomic_store_n(&worker->signal_busy,1,__ATOMIC_SEQ_CST);
+    SatState* sat_state = __atomic_load_n(&worker->sat_state,__ATOMIC_SEQ_CST);
+    if(sat_state!=NULL) sat_interrupt(sat_state);
+    __atomic_store_n(&worker->signal_busy,0,__ATOMIC_SEQ_CST);
+  }
+}
+
+//solves sat state under the assumptions of each line of a file (literals ending
+//with 0), in turn, printing the result and the final conflict of each
+//what is learned under some assumptions is kept for the next ones, and each gets
+//the whole budget
+//a line with a literal that is not of the cnf, or with more literals than the cnf
+//has vars, is not solved: its result is ERROR
+//returns 0 if the file cannot be read, 1 otherwise
+BOOLEAN solve_assumption_file(SatState* sat_state, const char* fname, const Budget* budget) {
+  FILE* file = fopen(fname,"r");
+  if(file==NULL) return 0;
+  long num_vars = (long)sat_var_count(sat_state);
+  c2dLiteral* assumptions = (c2dLiteral*)malloc((num_vars+1)*sizeof(c2dLiteral));
+  char* line = NULL;
+  size_t line_size = 0;
+  int query = 0;
+  while(!interrupted && getline(&line,&line_size,file)!=-1) {
+    if(line[0]=='c') continue;
+    c2dSize size = 0;
+    char* p = line;
+    char* end;
+    long index;
+    const char* error = NULL;
+    while(error==NULL && (index = strtol(p,&end,10))!=0 && end!=p) {
+      if(labs(index)>num_vars) error = "a literal which is not of the cnf";
+      else if(size==(c2dSize)num_vars) error = "more literals than the cnf has vars";
+      else assumptions[size++] = index;
+      p = end;
+    }
+    if(error!=NULL) {
+      printf("c query %d: %s\nERROR\n",++query,error);
+      continue;
+    }
+    if(end==p && size==0) continue; //no literals on the line
+
+    double start = seconds_now();
+    sat_set_budget(sat_state,budget->conflicts,budget->propagations,budget->seconds,budget->megabytes);
+    BOOLEAN result = sat_solve_assumptions(sat_state,assumptions,size);
+    printf("c query %d (%lu assumptions) in %.3fs\n",++query,size,seconds_now()-start);
+    printf("%s\n",result==UNKNOWN? "UNKNOWN": result? "SAT": "UNSAT");
+    if(result==0) {
+      c2dSize conflict_size;
+      const c2dLiteral* conflict = sat_final_conflict(sat_state,&conflict_size);
+      printf("c final conflict:");
+      for(c2dSize k=0; k<conflict_size; k++) printf(" %ld",conflict[k]);
+      printf("\n");
+    }
+  }
+  sat_undo_unit_resolution(sat_state);
+  free(line);
+  free(assumptions);
+  fclose(file);
+  return 1;
+}
+
+/******************************************************************************
+ * Batch: many cnf files solved on a pool of threads, one file per thread at a time
+ ******************************************************************************/
+
+void add_instance(BatchPool* batch, const char* fname) {
+  struct stat info;
+  if(stat(fname,&info)!=0 || !S_ISREG(info.st_mode)) {
+    printf("c cannot read %s\n",fname);
+    return;
+  }
+  if(batch->num_instances==batch->instances_limit) {
+    batch->instances_limit = 2*batch->instances_limit+1;
+    batch->instances = (Instance*)realloc(batch->instances,batch->instances_limit*sizeof(Instance));
+  }
+  Instance* instance = batch->instances+batch->num_instances++;
+  instance->fname = strdup(fname);
+  instance->size = info.st_size;
+}
+
+//adds the .cnf files of a directory, or the files listed in a file (one per line)
+//returns 0 if path cannot be read, 1 otherwise
+BOOLEAN add_instances(BatchPool* batch, const char* path) {
+  DIR* dir = opendir(path);
+  if(dir!=NULL) {
+    struct dirent* entry;
+    while((entry = readdir(dir))!=NULL) {
+      size_t length = strlen(entry->d_name);
+      if(length<=4 || strcmp(entry->d_name+length-4,".cnf")!=0) continue;
+      char* fname = (char*)malloc(strlen(path)+length+2);
+      sprintf(fname,"%s/%s",path,entry->d_name);
+      add_instance(batch,fname);
+      free(fname);
+    }
+    closedir(dir);
+    return 1;
+  }
+  FILE* list = fopen(path,"r");
+  if(list==NULL) return 0;
+  char* line = NULL;
+  size_t line_size = 0;
+  ssize_t length;
+  while((length = getline(&line,&line_size,list))!=-1) {
+    while(length>0 && (line[length-1]=='\n' || line[length-1]=='\r' || line[length-1]==' ')) line[--length] = '\0';
+    if(length>0) add_instance(batch,line);
+  }
+  free(line);
+  fclose(list);
+  return 1;
+}
+
+//largest first
+int compare_instances(const void* a, const void* b) {
+  off_t size1 = ((const Instance*)a)->size;
+  off_t size2 = ((const Instance*)b)->size;
+  return (size1<size2)-(size1>size2);
+}
+
+//solves instances until there are none left, or SIGINT, printing a line for each:
+//file, result, seconds (parsing included, model check too), and stats
+void* batch_worker(void* arg) {
+  Worker* worker = (Worker*)arg;
+  BatchPool* batch = worker->batch;
+  int i;
+  while(!interrupted && (i = __atomic_fetch_add(&batch->next,1,__ATOMIC_RELAXED))<batch->num_instances) {
+    Instance* instance = batch->instances+i;
+    double start = seconds_now();
+    SatState* sat_state = sat_state_new(instance->fname);
+    if(sat_state==NULL) {
+      pthread_mutex_lock(&batch->print_lock);
+      printf("%s ERROR cannot read\n",instance->fname);
+      pthread_mutex_unlock(&batch->print_lock);
+      continue;
+    }
+    sat_set_phase_mode(sat_state,batch->phase_mode);
+    sat_set_restart_mode(sat_state,batch->restart_mode);
+    sat_set_budget(sat_state,batch->budget.conflicts,batch->budget.propagations,batch->budget.seconds,batch->budget.megabytes);
+    __atomic_store_n(&worker->sat_state,sat_state,__ATOMIC_SEQ_CST);
+    if(interrupted) sat_interrupt(sat_state); //SIGINT came before the handler could see it
+    BOOLEAN result = sat(worker);
+    //a model which falsifies a clause is a bug of the solver, reported as an error
+    c2dSize falsified = (result==1 && batch->check_models? sat_falsified_clause(sat_state,worker->model,1,sat_clause_count(sat_state)): 0);
+    double seconds = seconds_now()-start;
+
+    pthread_mutex_lock(&batch->print_lock);
+    if(falsified!=0) printf("%s ERROR model falsifies clause %lu\n",instance->fname,falsified);
+    else batch->num_results[result==UNKNOWN? 2: result]++;
+    if(falsified==0) printf("%s %s %.3fs vars %lu clauses %lu learned %lu restarts %lu thread %d\n",instance->fname,
+      result==UNKNOWN? "UNKNOWN": result? "SAT": "UNSAT",seconds,sat_var_count(sat_state),sat_clause_count(sat_state),
+      sat_learned_clause_count(sat_state),sat_restart_count(sat_state),worker->id);
+    fflush(stdout);
+    pthread_mutex_unlock(&batch->print_lock);
+    __atomic_store_n(&worker->sat_state,NULL,__ATOMIC_SEQ_CST);
+    while(__atomic_load_n(&worker->signal_busy,__ATOMIC_SEQ_CST)); //the handler may still use it
+    sat_state_free(sat_state);
+  }
+  return NULL;
+}
+
+//solves the instances of batch on num_threads threads, largest first
+//ctrl-c stops the searches in progress, which report UNKNOWN, and the instances
+//not started yet are left out
+void solve_batch(BatchPool* batch, int num_threads) {
+  qsort(batch->instances,batch->num_instances,sizeof(Instance),compare_instances);
+  pthread_mutex_init(&batch->print_lock,NULL);
+  double start = seconds_now();
+
+  Worker* workers = (Worker*)calloc(num_threads,sizeof(Worker));
+  pthread_t* threads = (pthread_t*)malloc(num_threads*sizeof(pthread_t));
+  for(int i=0; i<num_threads; i++) {
+    workers[i].id = i;
+    workers[i].batch = batch;
+  }
+  signal_workers = workers;
+  signal_num_workers = num_threads;
+  for(int i=0; i<num_threads; i++) pthread_create(threads+i,NULL,batch_worker,workers+i);
+  for(int i=0; i<num_threads; i++) {
+    pthread_join(threads[i],NULL);
+    free(workers[i].model);
+  }
+  signal_num_workers = 0;
+
+  int num_started = (batch->next<batch->num_instances? batch->next: batch->num_instances);
+  if(num_started<batch->num_instances) printf("c interrupted: %d instances not started\n",batch->num_instances-num_started);
+  printf("c %d instances: %d SAT, %d UNSAT, %d UNKNOWN in %.3fs on %d threads\n",batch->num_instances,
+    batch->num_results[1],batch->num_results[0],batch->num_results[2],seconds_now()-start,num_threads);
+  pthread_mutex_destroy(&batch->print_lock);
+  free(threads);
+  free(workers);
+}
+
 int main(int argc, char* argv[]) {  
-  char USAGE_MSG[] = "Usage: ./sat -c <cnf_file>\n";
+  char USAGE_MSG[] = "Usage: ./sat -c <cnf_file> [-phase <mode>] [-restart <mode>] [-j <threads>] [-cube <depth>]\n"
+    "           [-conflicts <n>] [-propagations <n>] [-time <seconds>] [-memory <MB>]\n"
+    "           [-model] [-nocheck] [-proof <file>]\n"
+    "       ./sat -c <cnf_file> -assume <file> [-phase <mode>] [-restart <mode>] [budgets]\n"
+    "       ./sat -batch <dir_or_list> [-batch ...] [-j <threads>] [-phase <mode>] [-restart <mode>] [budgets]\n"
+    "  -phase: positive, saved (default), original, inverted or best\n"
+    "          (the last three reset the saved phases every now and then)\n"
+    "  -restart: none, luby or glucose (default)\n"
+    "  -j: number of threads solving the cnf, each in its own configuration\n"
+    "      (the first one as above); the first answer wins (default 1)\n"
+    "  -cube: split the cnf into cubes by up to depth lookahead splits, and\n"
+    "         solve them on the threads of -j instead (default 0: no cubes)\n"
+    "  -assume: solve the cnf under the assumptions of each line of the file\n"
+    "           (literals ending with 0), in turn, keeping the learned clauses\n"
+    "  -conflicts, -propagations, -time, -memory: budgets of each search (of each\n"
+    "             thread, and each query of -assume); UNKNOWN once one runs out\n"
+    "             (default 0: no limit). -memory is that of the learned clauses\n"
+    "  -batch: solve the .cnf files of a directory, or the files listed in a file\n"
+    "          (one per line), largest first, each on one of the -j threads;\n"
+    "          prints a line per file: result, seconds and stats\n"
+    "  -model: print the satisfying assignment found, as DIMACS v lines\n"
+    "  -nocheck: do not check the satisfying assignment against every clause\n"
+    "            (checked by default, by several threads for large cnfs)\n"
+    "  -proof: write a binary DRAT proof of the clauses learned and deleted to\n"
+    "          the file, ending with the empty clause if UNSAT; one thread only\n"
+    "          (no -j, -cube, -assume or -batch)\n";
   char* cnf_fname  = NULL;
+  char* phase_mode = "saved";
+  char* restart_mode = "glucose";
+  int num_threads = 1;
+  int cube_depth = 0;
+  char* assume_fname = NULL;
+  Budget budget = {0,0,0,0};
+  BatchPool batch = {NULL,0,0,0};
+  BOOLEAN batched = 0;
+  BOOLEAN print_models = 0;
+  BOOLEAN check_models = 1;
+  char* proof_fname = NULL;
 
-  if(argc==3 && strcmp("-c",argv[1])==0) cnf_fname = argv[2];
-  else {
+  for(int i=1; i<argc; i++) {
+    if(strcmp("-c",argv[i])==0 && i+1<argc) cnf_fname = argv[++i];
+    else if(strcmp("-phase",argv[i])==0 && i+1<argc) phase_mode = argv[++i];
+    else if(strcmp("-restart",argv[i])==0 && i+1<argc) restart_mode = argv[++i];
+    else if(strcmp("-j",argv[i])==0 && i+1<argc && atoi(argv[i+1])>0) num_threads = atoi(argv[++i]);
+    else if(strcmp("-cube",argv[i])==0 && i+1<argc && atoi(argv[i+1])>=0) cube_depth = atoi(argv[++i]);
+    else if(strcmp("-assume",argv[i])==0 && i+1<argc) assume_fname = argv[++i];
+    else if(strcmp("-model",argv[i])==0) print_models = 1;
+    else if(strcmp("-nocheck",argv[i])==0) check_models = 0;
+    else if(strcmp("-proof",argv[i])==0 && i+1<argc) proof_fname = argv[++i];
+    else if(strcmp("-batch",argv[i])==0 && i+1<argc) {
+      batched = 1;
+      if(!add_instances(&batch,argv[++i])) {
+        printf("cannot read %s\n",argv[i]);
+        exit(1);
+      }
+    }
+    else if(strcmp("-conflicts",argv[i])==0 && i+1<argc && atol(argv[i+1])>=0) budget.conflicts = atol(argv[++i]);
+    else if(strcmp("-propagations",argv[i])==0 && i+1<argc && atol(argv[i+1])>=0) budget.propagations = atol(argv[++i]);
+    else if(strcmp("-time",argv[i])==0 && i+1<argc && atof(argv[i+1])>=0) budget.seconds = atof(argv[++i]);
+    else if(strcmp("-memory",argv[i])==0 && i+1<argc && atol(argv[i+1])>=0) budget.megabytes = atol(argv[++i]);
+    else {
+      printf("%s",USAGE_MSG);
+      exit(1);
+    }
+  }
+  //the proof is of the clauses of a single sat state
+  if(proof_fname!=NULL && (batched || assume_fname!=NULL || num_threads>1 || cube_depth>0)) {
+    printf("%s",USAGE_MSG);
+    exit(1);
+  }
+  if(batched) {
+    //the modes are checked by a sat state, that of the first instance which can be read
+    for(int i=0; i<batch.num_instances; i++) {
+      SatState* sat_state = sat_state_new(batch.instances[i].fname);
+      if(sat_state==NULL) continue;
+      BOOLEAN known = sat_set_phase_mode(sat_state,phase_mode) && sat_set_restart_mode(sat_state,restart_mode);
+      sat_state_free(sat_state);
+      if(!known) {
+        printf("%s",USAGE_MSG);
+        exit(1);
+      }
+      break;
+    }
+    batch.phase_mode = phase_mode;
+    batch.restart_mode = restart_mode;
+    batch.budget = budget;
+    batch.check_models = check_models;
+    //ctrl-c stops the searches, which then report UNKNOWN
+    signal(SIGINT,interrupt_workers);
+    solve_batch(&batch,num_threads);
+    signal(SIGINT,SIG_DFL);
+    for(int i=0; i<batch.num_instances; i++) free(batch.instances[i].fname);
+    free(batch.instances);
+    return 0;
+  }
+  if(cnf_fname==NULL) {
     printf("%s",USAGE_MSG);
     exit(1);
   }
   
   //construct a sat state and then check satisfiability
   SatState* sat_state = sat_state_new(cnf_fname);
-  if(sat(sat_state)) printf("SAT\n");
+  if(sat_state==NULL) {
+    printf("cannot read %s\n",cnf_fname);
+    exit(1);
+  }
+  if(!sat_set_phase_mode(sat_state,phase_mode) || !sat_set_restart_mode(sat_state,restart_mode)) {
+    printf("%s",USAGE_MSG);
+    exit(1);
+  }
+
+  //ctrl-c stops the searches, which then report UNKNOWN
+  Worker self = {0};
+  self.sat_state = sat_state;
+  signal_workers = &self;
+  signal_num_workers = 1;
+  signal(SIGINT,interrupt_workers);
+
+  if(assume_fname!=NULL) {
+    BOOLEAN read = solve_assumption_file(sat_state,assume_fname,&budget);
+    if(read) printf("c learned clauses %lu, restarts %lu\n",sat_learned_clause_count(sat_state),sat_restart_count(sat_state));
+    else printf("cannot read %s\n",assume_fname);
+    signal(SIGINT,SIG_DFL);
+    sat_state_free(sat_state);
+    return read? 0: 1;
+  }
+
+  //the proof is written by its own thread while sat state is solved
+  ProofWriter* proof = NULL;
+  if(proof_fname!=NULL) {
+    proof = proof_writer_new(proof_fname);
+    if(proof==NULL) {
+      printf("cannot write %s\n",proof_fname);
+      sat_state_free(sat_state);
+      return 1;
+    }
+    proof_writer_attach(proof,sat_state);
+  }
+
+  //the first thread solves sat state itself, the others copies of it
+  Worker* workers = (Worker*)calloc(num_threads,sizeof(Worker));
+  for(int i=0; i<num_threads; i++) {
+    workers[i].id = i;
+    workers[i].sat_state = (i==0? sat_state: sat_state_clone(sat_state));
+    workers[i].phase_mode = (i==0? phase_mode: portfolio_phases[(i/2)%4]);
+    workers[i].restart_mode = (i==0? restart_mode: portfolio_restarts[i%2]);
+    sat_set_phase_mode(workers[i].sat_state,workers[i].phase_mode);
+    sat_set_restart_mode(workers[i].sat_state,workers[i].restart_mode);
+    if(i>0) sat_set_seed(workers[i].sat_state,i);
+    sat_set_budget(workers[i].sat_state,budget.conflicts,budget.propagations,budget.seconds,budget.megabytes);
+  }
+  signal_workers = workers;
+  signal_num_workers = num_threads;
+
+  Worker* solver = workers;
+  if(cube_depth>0) {
+    int winner = cube_and_conquer(workers,num_threads,cube_depth);
+    if(winner>=0) solver = workers+winner;
+    else solver->result = (winner==-1? 0: UNKNOWN); //all cubes refuted, or not all solved
+  }
+  else if(num_threads==1) solver->result = sat(solver);
+  else {
+    int winner = portfolio(workers,num_threads);
+    if(winner>=0) solver = workers+winner;
+    else solver->result = UNKNOWN; //all threads stopped
+  }
+  signal(SIGINT,SIG_DFL);
+
+  BOOLEAN proof_written = 1;
+  if(proof!=NULL) {
+    sat_end_proof(sat_state,solver->result==0);
+    proof_written = proof_writer_close(proof);
+    if(!proof_written) printf("c ERROR: cannot write the proof to %s\n",proof_fname);
+  }
+
+  c2dSize falsified = 0;
+  if(solver->result==1 && check_models) {
+    double start = seconds_now();
+    falsified = check_model(solver->sat_state,solver->model);
+    if(falsified==0) printf("c model checked against %lu clauses in %.3fs\n",sat_clause_count(solver->sat_state),seconds_now()-start);
+    else printf("c ERROR: the model falsifies clause %lu\n",falsified);
+  }
+
+  if(solver->result==UNKNOWN) printf("UNKNOWN\n");
+  else if(solver->result) printf("SAT\n");
   else printf("UNSAT\n");
-  sat_state_free(sat_state);
+  if(solver->result==1 && print_models) print_model(solver->model,sat_var_count(solver->sat_state));
+  if(num_threads>1 && cube_depth==0 && solver->result!=UNKNOWN)
+    printf("c solved by thread %d (phase %s, restart %s)\n",solver->id,solver->phase_mode,solver->restart_mode);
+  printf("c learned clauses %lu, literals %lu, removed by minimization %lu, restarts %lu\n",
+    sat_learned_clause_count(solver->sat_state),sat_learned_literal_count(solver->sat_state),
+    sat_minimized_literal_count(solver->sat_state),sat_restart_count(solver->sat_state));
+  for(int i=0; i<num_threads; i++) {
+    sat_state_free(workers[i].sat_state);
+    free(workers[i].model);
+  }
+  free(workers);
 
-  return 0;
+  return (falsified==0 && proof_written)? 0: 1;
 }
 
 /******************************************************************************
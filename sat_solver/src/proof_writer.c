@@ -0,0 +1,77 @@
+#include "proof_writer.h"
+
+/******************************************************************************
+ * Proof writer (see proof_writer.h)
+ ******************************************************************************/
+
+//writes the full buffers as they come, until the writer is closed and none is left
+//a buffer stays full (and away from the sat state) until it is written
+void* proof_writer_run(void* arg) {
+  ProofWriter* writer = (ProofWriter*)arg;
+  pthread_mutex_lock(&writer->lock);
+  for(;;) {
+    while(writer->num_full==0 && !writer->closing) pthread_cond_wait(&writer->changed,&writer->lock);
+    if(writer->num_full==0) break; //closing
+    unsigned char* buffer = writer->buffers[writer->head];
+    size_t size = writer->sizes[writer->head];
+    pthread_mutex_unlock(&writer->lock);
+    BOOLEAN written = (fwrite(buffer,1,size,writer->file)==size);
+    pthread_mutex_lock(&writer->lock);
+    if(!written) writer->failed = 1;
+    writer->head = (writer->head+1)%PROOF_BUFFERS;
+    writer->num_full--;
+    pthread_cond_broadcast(&writer->changed);
+  }
+  pthread_mutex_unlock(&writer->lock);
+  return NULL;
+}
+
+//the flush function of the sat state: queues the buffer being filled, and returns
+//the next one once it is written
+unsigned char* proof_writer_flush(void* sink, unsigned char* bytes, size_t num_bytes) {
+  ProofWriter* writer = (ProofWriter*)sink;
+  pthread_mutex_lock(&writer->lock);
+  writer->sizes[(writer->head+writer->num_full)%PROOF_BUFFERS] = num_bytes;
+  writer->num_full++;
+  pthread_cond_broadcast(&writer->changed);
+  while(writer->num_full==PROOF_BUFFERS) pthread_cond_wait(&writer->changed,&writer->lock);
+  unsigned char* next = writer->buffers[(writer->head+writer->num_full)%PROOF_BUFFERS];
+  pthread_mutex_unlock(&writer->lock);
+  return next;
+}
+
+ProofWriter* proof_writer_new(const char* fname) {
+  FILE* file = fopen(fname,"wb");
+  if(file==NULL) return NULL;
+  ProofWriter* writer = (ProofWriter*)malloc(sizeof(ProofWriter));
+  writer->file = file;
+  for(int i=0; i<PROOF_BUFFERS; i++) writer->buffers[i] = (unsigned char*)malloc(PROOF_BUFFER_BYTES);
+  writer->head = 0;
+  writer->num_full = 0;
+  writer->closing = 0;
+  writer->failed = 0;
+  pthread_mutex_init(&writer->lock,NULL);
+  pthread_cond_init(&writer->changed,NULL);
+  pthread_create(&writer->thread,NULL,proof_writer_run,writer);
+  return writer;
+}
+
+void proof_writer_attach(ProofWriter* writer, SatState* sat_state) {
+  sat_set_proof(sat_state,proof_writer_flush,writer,writer->buffers[0],PROOF_BUFFER_BYTES);
+}
+
+BOOLEAN proof_writer_close(ProofWriter* writer) {
+  pthread_mutex_lock(&writer->lock);
+  writer->closing = 1;
+  pthread_cond_broadcast(&writer->changed);
+  pthread_mutex_unlock(&writer->lock);
+  pthread_join(writer->thread,NULL);
+
+  BOOLEAN written = !writer->failed;
+  if(fclose(writer->file)!=0) written = 0;
+  for(int i=0; i<PROOF_BUFFERS; i++) free(writer->buffers[i]);
+  pthread_cond_destroy(&writer->changed);
+  pthread_mutex_destroy(&writer->lock);
+  free(writer);
+  return written;
+}